@@ -0,0 +1,156 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unordered_set>
+#include <vector>
+
+#include <state.h>
+#include <dice.h>
+#include <position.h>
+#include <movegen.h>
+#include <search.h>
+#include <book.h>
+
+/*
+ * Builds the opening book for 'my-player':
+ *
+ *  - the opening move for each of the 15 possible first rolls, taken from
+ *    published rollout results, and
+ *  - the reply to every legal opening play for each of the 21 rolls,
+ *    searched with much wider pruning limits than the player can afford
+ *    during a game.
+ */
+
+namespace {
+
+/* Best opening plays in PLAYER_BELOW's notation (point_from, roll) */
+struct opening {
+  unsigned short dice[NUM_DICE];
+  game_move moves[NUM_DICE];
+} const OPENINGS[] = {
+  { { 1, 2 }, { { 13, 2 }, {  6, 1 } } }, // 13/11 6/5
+  { { 1, 3 }, { {  8, 3 }, {  6, 1 } } }, // 8/5 6/5
+  { { 1, 4 }, { { 24, 1 }, { 13, 4 } } }, // 24/23 13/9
+  { { 1, 5 }, { { 13, 5 }, {  6, 1 } } }, // 13/8 6/5
+  { { 1, 6 }, { { 13, 6 }, {  8, 1 } } }, // 13/7 8/7
+  { { 2, 3 }, { { 24, 3 }, { 13, 2 } } }, // 24/21 13/11
+  { { 2, 4 }, { {  8, 4 }, {  6, 2 } } }, // 8/4 6/4
+  { { 2, 5 }, { { 13, 5 }, { 13, 2 } } }, // 13/8 13/11
+  { { 2, 6 }, { { 24, 6 }, { 13, 2 } } }, // 24/18 13/11
+  { { 3, 4 }, { { 24, 4 }, { 13, 3 } } }, // 24/20 13/10
+  { { 3, 5 }, { {  8, 5 }, {  6, 3 } } }, // 8/3 6/3
+  { { 3, 6 }, { { 24, 6 }, { 13, 3 } } }, // 24/18 13/10
+  { { 4, 5 }, { { 24, 4 }, { 13, 5 } } }, // 24/20 13/8
+  { { 4, 6 }, { { 24, 6 }, { 13, 4 } } }, // 24/18 13/9
+  { { 5, 6 }, { { 24, 6 }, { 18, 5 } } }, // 24/13
+};
+
+/* Pruning limits for the book search: look at (nearly) everything */
+prune_limits const BOOK_PRUNE = { 24, 0.5 };
+
+struct book_builder {
+  book_builder() : entries(), keys() {}
+
+  std::vector<book_entry> entries;
+  std::unordered_set<uint64_t> keys;
+};
+
+void
+add(book_builder * const book, position const * const pos,
+    multi_move const * const mmove)
+{
+  book_entry e;
+  book_entry_init(&e, pos, mmove);
+
+  if (book->keys.insert(e.key).second) { book->entries.push_back(e); }
+}
+
+} // end anon namespace
+
+
+int
+main(int argc, char **argv)
+{
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s book-file\n", argv[0]);
+    return 1;
+  }
+
+  search_config cfg;
+  search_config_init(&cfg);
+  for (size_t phase = 0; phase < NUM_PHASES; ++phase)
+    cfg.prune[phase] = BOOK_PRUNE;
+
+  book_builder book;
+  game_state start;
+  position root;
+
+  initialize_state(&start);
+  start.player = PLAYER_BELOW;
+  position_init(&root, &start);
+
+  unsigned long nodes = 0;
+
+  for (opening const & o : OPENINGS) {
+    root.state.dice[0] = o.dice[0];
+    root.state.dice[1] = o.dice[1];
+
+    /* First ply: the known best play */
+    multi_move mmove;
+    mmove.num_moves = NUM_DICE;
+    mmove.moves[0] = o.moves[0];
+    mmove.moves[1] = o.moves[1];
+    add(&book, &root, &mmove);
+
+    /* Second ply: replies to any opening play */
+    play_vector plays;
+    generate_plays(&root, &plays);
+
+    for (play const & p : plays) {
+      position reply = p.result;
+      position_switch_player(&reply);
+
+      for (roll_info const * roll = roll_begin(); roll != roll_end(); ++roll) {
+        reply.state.dice[0] = roll->dice[0];
+        reply.state.dice[1] = roll->dice[1];
+
+        search_stats stats;
+        search_root(&reply, &cfg, NULL, &mmove, &stats);
+        nodes += stats.nodes;
+        add(&book, &reply, &mmove);
+      }
+    }
+
+    fprintf(stderr, "%hu-%hu: %zu entries, %lu nodes\n", o.dice[0], o.dice[1],
+            book.entries.size(), nodes);
+  }
+
+  if (!book_write(argv[1], book.entries.data(), book.entries.size())) {
+    perror(argv[1]);
+    return 1;
+  }
+
+  /* Read the book back and make sure every opening move is found */
+  if (!book_open(argv[1])) {
+    fprintf(stderr, "Unable to read back '%s'\n", argv[1]);
+    return 1;
+  }
+
+  for (opening const & o : OPENINGS) {
+    multi_move mmove;
+
+    root.state.dice[0] = o.dice[1]; // either order of the dice works
+    root.state.dice[1] = o.dice[0];
+
+    if (!book_lookup(&root, &mmove)) {
+      fprintf(stderr, "Opening %hu-%hu missing or illegal\n",
+              o.dice[0], o.dice[1]);
+      return 1;
+    }
+  }
+
+  fprintf(stderr, "Wrote %zu entries to '%s'\n", book_size(), argv[1]);
+  return 0;
+}
+
+/* EOF */
@@ -0,0 +1,176 @@
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+#include <book.h>
+#include <movegen.h>
+
+namespace {
+
+char const BOOK_MAGIC[8] = { 'B', 'G', 'B', 'O', 'O', 'K', 0, 0 };
+
+/* The mapped book (stays mapped for the lifetime of the process) */
+book_entry const * entries = NULL;
+size_t num_entries = 0;
+
+/* Translate canonical (PLAYER_BELOW) points for 'player' and vice versa */
+unsigned short
+canonical_point(signed char const player, unsigned short const point)
+{
+  return (player == PLAYER_BELOW ? point : mirror_point(point));
+}
+
+} // end anon namespace
+
+
+uint64_t
+book_key(position const * const pos)
+{
+  assert(pos);
+
+  unsigned short const * const dice = pos->state.dice;
+  unsigned int const low  = std::min(dice[0], dice[1]),
+                     high = std::max(dice[0], dice[1]);
+
+  return position_canonical_hash(pos) ^ ((low * 8 + high) * 0x9e3779b97f4a7c15ULL);
+}
+
+bool
+book_open(char const * const path, size_t const max_bytes)
+{
+  assert(path);
+
+  int const fd = open(path, O_RDONLY);
+  if (fd < 0) { return false; }
+
+  struct stat st;
+  void * map = MAP_FAILED;
+
+  if (fstat(fd, &st) == 0 && (size_t) st.st_size >= sizeof(book_header) &&
+      (size_t) st.st_size <= max_bytes)
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  close(fd); // the mapping stays valid
+
+  if (map == MAP_FAILED) { return false; }
+
+  book_header const * const header = (book_header const *) map;
+  size_t const size = st.st_size;
+
+  if (memcmp(header->magic, BOOK_MAGIC, sizeof(BOOK_MAGIC)) ||
+      header->version != BOOK_VERSION ||
+      size != sizeof(book_header) + header->entries * sizeof(book_entry)) {
+    munmap(map, size);
+    return false;
+  }
+
+  entries     = (book_entry const *) (header + 1);
+  num_entries = header->entries;
+  return true;
+}
+
+size_t
+book_size()
+{
+  return num_entries;
+}
+
+bool
+book_lookup(position const * const pos, multi_move * const mmove)
+{
+  assert(pos && mmove);
+
+  uint64_t const key = book_key(pos);
+  book_entry const * const end = entries + num_entries;
+  book_entry const * const e =
+    std::lower_bound(entries, end, key,
+                     [](book_entry const & a, uint64_t const k) {
+                       return a.key < k;
+                     });
+
+  if (e == end || e->key != key) { return false; }
+
+  unsigned short const * const dice = pos->state.dice;
+  if (e->dice[0] != std::min(dice[0], dice[1]) ||
+      e->dice[1] != std::max(dice[0], dice[1]) ||
+      e->num_moves > MAX_MOVES)
+    return false;
+
+  /* Never trust the book blindly: the play has to be legal in 'pos' */
+  signed char const player = pos->state.player;
+  position next = *pos;
+
+  mmove->num_moves = e->num_moves;
+
+  for (size_t cc = 0; cc < e->num_moves; ++cc) {
+    game_move * const move = &mmove->moves[cc];
+
+    move->point_from = canonical_point(player, e->point_from[cc]);
+    move->roll       = e->roll[cc];
+
+    if (!can_move_checker(&next, move->point_from, move->roll)) { return false; }
+    position_move(&next, move);
+  }
+
+  play_vector plays;
+  generate_plays(pos, &plays);
+
+  unsigned long long const result = position_hash(&next);
+
+  for (play const & p : plays)
+    if (position_hash(&p.result) == result) { return true; }
+
+  return false;
+}
+
+void
+book_entry_init(book_entry * const entry, position const * const pos,
+                multi_move const * const mmove)
+{
+  assert(entry && pos && mmove && mmove->num_moves <= MAX_MOVES);
+
+  unsigned short const * const dice = pos->state.dice;
+
+  memset(entry, 0, sizeof(*entry));
+  entry->key       = book_key(pos);
+  entry->dice[0]   = std::min(dice[0], dice[1]);
+  entry->dice[1]   = std::max(dice[0], dice[1]);
+  entry->num_moves = mmove->num_moves;
+
+  for (size_t cc = 0; cc < mmove->num_moves; ++cc) {
+    entry->point_from[cc] = canonical_point(pos->state.player,
+                                            mmove->moves[cc].point_from);
+    entry->roll[cc]       = mmove->moves[cc].roll;
+  }
+}
+
+bool
+book_write(char const * const path, book_entry * const book,
+           size_t const size)
+{
+  assert(path && (book || size == 0));
+
+  std::sort(book, book + size, [](book_entry const & a, book_entry const & b) {
+    return a.key < b.key;
+  });
+
+  book_header header;
+  memcpy(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC));
+  header.version = BOOK_VERSION;
+  header.entries = size;
+
+  FILE * const f = fopen(path, "wb");
+  if (!f) { return false; }
+
+  bool const ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+                  fwrite(book, sizeof(book_entry), size, f) == size;
+
+  return (fclose(f) == 0) && ok;
+}
+
+/* EOF */
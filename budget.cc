@@ -0,0 +1,123 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include <budget.h>
+
+namespace {
+
+char const * const POOL_NAMES[NUM_POOLS] = { "tt", "book", "work" };
+
+unsigned int const DEFAULT_RATIO[NUM_POOLS] = {
+  50, // tt: the more replies are remembered, the fewer are searched again
+  25, // book: far more than the shipped book needs
+  25, // work
+};
+
+/* Address space currently used by the process (0 if unknown) */
+size_t
+address_space_in_use()
+{
+  FILE * const f = fopen("/proc/self/statm", "r");
+  if (!f) { return 0; }
+
+  unsigned long pages = 0;
+  if (fscanf(f, "%lu", &pages) != 1) { pages = 0; }
+  fclose(f);
+
+  return pages * sysconf(_SC_PAGESIZE);
+}
+
+/*
+ * Parse 'name=percent,...' into 'ratio'. The pools not given share what is
+ * left of 100 percent in the proportions they had in 'ratio'.
+ */
+bool
+parse_ratios(char const * str, unsigned int ratio[NUM_POOLS])
+{
+  unsigned int parsed[NUM_POOLS];
+  bool given[NUM_POOLS] = {};
+
+  while (*str) {
+    char name[16];
+    unsigned int percent;
+    int len = 0;
+
+    if (sscanf(str, "%15[a-z]=%u%n", name, &percent, &len) != 2) { return false; }
+
+    size_t pool;
+    for (pool = 0; pool < NUM_POOLS; ++pool)
+      if (!strcmp(name, POOL_NAMES[pool])) { break; }
+
+    if (pool == NUM_POOLS || percent > 100) { return false; }
+    parsed[pool] = percent;
+    given[pool]  = true;
+
+    str += len;
+    if (*str == ',') { ++str; }
+  }
+
+  unsigned int sum = 0, weight = 0;
+  for (size_t pool = 0; pool < NUM_POOLS; ++pool) {
+    if (given[pool]) { sum += parsed[pool]; } else { weight += ratio[pool]; }
+  }
+  if (sum > 100) { return false; }
+
+  /* Rounding down leaves the remainder to the last pool not given */
+  unsigned int left = 100 - sum;
+  size_t last = NUM_POOLS;
+
+  for (size_t pool = 0; pool < NUM_POOLS; ++pool) {
+    if (given[pool]) { continue; }
+
+    parsed[pool] = (weight ? (100 - sum) * ratio[pool] / weight : 0);
+    left -= parsed[pool];
+    last  = pool;
+  }
+  if (last < NUM_POOLS) { parsed[last] += left; }
+
+  memcpy(ratio, parsed, sizeof(parsed));
+  return true;
+}
+
+} // end anon namespace
+
+
+bool
+budget_init(memory_budget * const budget)
+{
+  assert(budget);
+
+  memcpy(budget->ratio, DEFAULT_RATIO, sizeof(budget->ratio));
+
+  char const * const env = getenv("PLAYER_MEMORY");
+  bool const ok = (!env || parse_ratios(env, budget->ratio));
+
+  struct rlimit rl;
+  budget->limit = 0;
+  if (getrlimit(RLIMIT_AS, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY)
+    budget->limit = rl.rlim_cur;
+
+  budget->in_use = address_space_in_use();
+
+  size_t available = BUDGET_DEFAULT;
+  if (budget->limit)
+    available = (budget->limit > budget->in_use ? budget->limit - budget->in_use : 0);
+
+  for (size_t pool = 0; pool < NUM_POOLS; ++pool)
+    budget->pool[pool] = available / 100 * budget->ratio[pool];
+
+  return ok;
+}
+
+char const *
+budget_pool_name(budget_pool const pool)
+{
+  assert(pool < NUM_POOLS);
+  return POOL_NAMES[pool];
+}
+
+/* EOF */
@@ -0,0 +1,206 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+#include <state.h>
+#include <position.h>
+#include <movegen.h>
+#include <search.h>
+#include <corpus.h>
+
+/*
+ * Builds a position corpus (see 'corpus.h') from
+ *
+ *  - the states the MCP sent to its players, taken from its logs (lines
+ *    "> 1 4-1: ..." as printed on stderr, also with the "[game]" prefix
+ *    of 'mcp -j'), and/or
+ *  - self-play games of random legal plays, which cover far more unusual
+ *    positions than any player would steer into.
+ *
+ *   ./mcp -n 100 my-player my-player 2> games.log
+ *   ./corpus-gen -g 100000 positions.corpus games.log
+ */
+
+namespace {
+
+typedef std::vector<corpus_entry> entry_vector;
+
+void
+add(entry_vector * const entries, position const * const pos)
+{
+  corpus_entry e;
+  corpus_entry_init(&e, pos);
+  entries->push_back(e);
+}
+
+/* Collect the states in the MCP log 'path' ("-": standard input) */
+bool
+read_log(entry_vector * const entries, char const * const path)
+{
+  FILE * const f = (strcmp(path, "-") ? fopen(path, "r") : stdin);
+  if (!f) { return false; }
+
+  char line[MAX_MESSAGE_LEN];
+
+  while (fgets(line, sizeof(line), f)) {
+    char const * msg = line;
+
+    if (*msg == '[') {
+      msg = strchr(msg, ']');
+      if (!msg) { continue; }
+      msg += 1 + strspn(msg + 1, " ");
+    }
+    if (strncmp(msg, "> ", 2)) { continue; }
+
+    game_state state;
+    if (!parse_state(msg + 2, &state)) { continue; }
+
+    position pos;
+    position_init(&pos, &state);
+    add(entries, &pos);
+  }
+
+  bool const ok = !ferror(f);
+  if (f != stdin) { fclose(f); }
+  return ok;
+}
+
+unsigned short
+roll_die(search_rng * const rng)
+{
+  return 1 + search_rng_next(rng) % 6;
+}
+
+/* Play one game of random legal plays and collect all its positions */
+void
+self_play(entry_vector * const entries, search_rng * const rng)
+{
+  game_state start;
+  position pos;
+  play_vector plays;
+
+  initialize_state(&start);
+  start.player = (search_rng_next(rng) & 1 ? PLAYER_BELOW : PLAYER_ABOVE);
+  position_init(&pos, &start);
+
+  /* The opening roll is never a double */
+  do {
+    pos.state.dice[0] = roll_die(rng);
+    pos.state.dice[1] = roll_die(rng);
+  } while (pos.state.dice[0] == pos.state.dice[1]);
+
+  while (1) {
+    add(entries, &pos);
+
+    generate_plays(&pos, &plays);
+    pos = plays[search_rng_next(rng) % plays.size()].result;
+
+    if (pos.off[side_of(pos.state.player)] == NUM_CHECKERS) { break; }
+
+    position_switch_player(&pos);
+    pos.state.dice[0] = roll_die(rng);
+    pos.state.dice[1] = roll_die(rng);
+  }
+}
+
+/* Map the corpus written to 'path' and look up a sample of its entries */
+bool
+verify(char const * const path)
+{
+  corpus c;
+  if (!corpus_open(&c, path)) { return false; }
+
+  bool ok = true;
+
+  for (size_t phase = 0; phase < NUM_PHASES; ++phase) {
+    corpus_entry const * begin, * end;
+    corpus_phase(&c, (game_phase) phase, &begin, &end);
+
+    size_t const num = end - begin;
+    size_t const step = (num > 1000 ? num / 1000 : 1);
+
+    for (corpus_entry const * e = begin; e < end; e += step) {
+      position pos;
+      corpus_entry_position(e, &pos);
+      ok = ok && (corpus_find(&c, &pos) == e);
+    }
+
+    fprintf(stderr, "%-8s %10zu positions\n", PHASE_NAMES[phase], num);
+  }
+
+  corpus_close(&c);
+  return ok;
+}
+
+void
+usage(char const * const prog)
+{
+  fprintf(stderr, "Usage: %s [-g games] [-s seed] corpus-file [mcp-log ...]\n"
+                  "  -g games - Add the positions of that many self-play games\n"
+                  "  -s seed  - Seed of the dice and plays of the self-play games\n"
+                  "  mcp-log  - Add the states sent by the MCP ('-': stdin)\n",
+          prog);
+}
+
+} // end anon namespace
+
+
+int
+main(int argc, char **argv)
+{
+  unsigned long games = 0;
+  unsigned long long seed = 1;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "g:s:")) != -1) {
+    switch (opt) {
+    case 'g': games = strtoul(optarg, NULL, 0); break;
+    case 's': seed  = strtoull(optarg, NULL, 0); break;
+    default:  usage(argv[0]); return 1;
+    }
+  }
+
+  if (optind >= argc) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  char const * const path = argv[optind++];
+  entry_vector entries;
+
+  for (int arg = optind; arg < argc; ++arg) {
+    if (!read_log(&entries, argv[arg])) {
+      perror(argv[arg]);
+      return 1;
+    }
+  }
+  size_t const logged = entries.size();
+
+  search_rng rng;
+  search_rng_seed(&rng, seed);
+
+  for (unsigned long game = 0; game < games; ++game)
+    self_play(&entries, &rng);
+
+  fprintf(stderr, "%zu positions from logs, %zu from %lu self-play games\n",
+          logged, entries.size() - logged, games);
+
+  long const written = corpus_write(path, entries.data(), entries.size());
+  if (written < 0) {
+    perror(path);
+    return 1;
+  }
+
+  if (!verify(path)) {
+    fprintf(stderr, "Unable to read back '%s'\n", path);
+    return 1;
+  }
+
+  fprintf(stderr, "Wrote %ld distinct positions to '%s'\n", written, path);
+  return 0;
+}
+
+/* EOF */
@@ -0,0 +1,189 @@
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+#include <book.h>
+#include <corpus.h>
+
+namespace {
+
+char const CORPUS_MAGIC[8] = { 'B', 'G', 'C', 'O', 'R', 'P', 'U', 'S' };
+
+bool
+entry_less(corpus_entry const & a, corpus_entry const & b)
+{
+  return (a.phase != b.phase ? a.phase < b.phase : a.key < b.key);
+}
+
+} // end anon namespace
+
+
+void
+corpus_entry_init(corpus_entry * const entry, position const * const pos)
+{
+  assert(entry && pos);
+
+  game_state const * const state = &pos->state;
+  signed char const player = state->player;
+
+  memset(entry, 0, sizeof(*entry));
+  entry->key   = book_key(pos);
+  entry->phase = position_phase(pos);
+
+  /* Point 'cc' as seen by the player on roll */
+  for (size_t cc = 1; cc <= POINTS; ++cc) {
+    size_t const point = (player == PLAYER_BELOW ? cc : mirror_point(cc));
+    entry->points[cc - 1] = state->board[point] * player;
+  }
+
+  entry->bar[0]  = bar_count(state, player);
+  entry->bar[1]  = bar_count(state, -player);
+  entry->off[0]  = pos->off[side_of(player)];
+  entry->off[1]  = pos->off[side_of(-player)];
+  entry->dice[0] = std::min(state->dice[0], state->dice[1]);
+  entry->dice[1] = std::max(state->dice[0], state->dice[1]);
+}
+
+void
+corpus_entry_position(corpus_entry const * const entry, position * const pos)
+{
+  assert(entry && pos);
+
+  game_state state;
+  signed short int * const b = state.board;
+
+  state.player  = PLAYER_BELOW;
+  state.dice[0] = entry->dice[0];
+  state.dice[1] = entry->dice[1];
+
+  for (size_t cc = 1; cc <= POINTS; ++cc) { b[cc] = entry->points[cc - 1]; }
+
+  b[POS_BAR] = 0;
+  set_lower_bar(&b[POS_BAR], entry->bar[0]);
+  set_higher_bar(&b[POS_BAR], entry->bar[1]);
+  b[POS_OFF] = entry->off[0] * PLAYER_BELOW + entry->off[1] * PLAYER_ABOVE;
+
+  position_init(pos, &state);
+}
+
+long
+corpus_write(char const * const path, corpus_entry * const entries,
+             size_t const num_entries)
+{
+  assert(path && (entries || num_entries == 0));
+
+  std::sort(entries, entries + num_entries, entry_less);
+  size_t const size = std::unique(entries, entries + num_entries,
+                                  [](corpus_entry const & a, corpus_entry const & b) {
+                                    return a.key == b.key;
+                                  }) - entries;
+
+  corpus_header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, CORPUS_MAGIC, sizeof(CORPUS_MAGIC));
+  header.version = CORPUS_VERSION;
+  header.entries = size;
+
+  /* Entries are grouped by phase: record where each group starts */
+  size_t cc = 0;
+  for (size_t phase = 0; phase <= NUM_PHASES; ++phase) {
+    while (cc < size && entries[cc].phase < phase) { ++cc; }
+    header.phase_begin[phase] = cc;
+  }
+
+  FILE * const f = fopen(path, "wb");
+  if (!f) { return -1; }
+
+  bool const ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+                  fwrite(entries, sizeof(corpus_entry), size, f) == size;
+
+  return (fclose(f) == 0 && ok ? (long) size : -1);
+}
+
+bool
+corpus_open(corpus * const c, char const * const path)
+{
+  assert(c && path);
+
+  memset(c, 0, sizeof(*c));
+
+  int const fd = open(path, O_RDONLY);
+  if (fd < 0) { return false; }
+
+  struct stat st;
+  void * map = MAP_FAILED;
+
+  if (fstat(fd, &st) == 0 && (size_t) st.st_size >= sizeof(corpus_header))
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  close(fd); // the mapping stays valid
+
+  if (map == MAP_FAILED) { return false; }
+
+  corpus_header const * const header = (corpus_header const *) map;
+  size_t const size = st.st_size;
+  bool valid = !memcmp(header->magic, CORPUS_MAGIC, sizeof(CORPUS_MAGIC)) &&
+               header->version == CORPUS_VERSION &&
+               size == sizeof(corpus_header) + header->entries * sizeof(corpus_entry) &&
+               header->phase_begin[0] == 0 &&
+               header->phase_begin[NUM_PHASES] == header->entries;
+
+  for (size_t phase = 0; valid && phase < NUM_PHASES; ++phase)
+    valid = header->phase_begin[phase] <= header->phase_begin[phase + 1];
+
+  if (!valid) {
+    munmap(map, size);
+    return false;
+  }
+
+  c->header  = header;
+  c->entries = (corpus_entry const *) (header + 1);
+  c->size    = size;
+  return true;
+}
+
+void
+corpus_close(corpus * const c)
+{
+  assert(c);
+
+  if (c->header) { munmap((void *) c->header, c->size); }
+  memset(c, 0, sizeof(*c));
+}
+
+void
+corpus_phase(corpus const * const c, game_phase const phase,
+             corpus_entry const ** const begin, corpus_entry const ** const end)
+{
+  assert(c && c->header && phase < NUM_PHASES && begin && end);
+
+  *begin = c->entries + c->header->phase_begin[phase];
+  *end   = c->entries + c->header->phase_begin[phase + 1];
+}
+
+corpus_entry const *
+corpus_find(corpus const * const c, position const * const pos)
+{
+  assert(c && pos);
+
+  if (!c->header) { return NULL; }
+
+  corpus_entry const * begin, * end;
+  corpus_phase(c, position_phase(pos), &begin, &end);
+
+  uint64_t const key = book_key(pos);
+  corpus_entry const * const e =
+    std::lower_bound(begin, end, key,
+                     [](corpus_entry const & a, uint64_t const k) {
+                       return a.key < k;
+                     });
+
+  return (e != end && e->key == key ? e : NULL);
+}
+
+/* EOF */
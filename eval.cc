@@ -0,0 +1,429 @@
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <eval.h>
+
+namespace {
+
+/* Board as seen by one side: everything measured in its own distances */
+struct side_view {
+  unsigned char own[DIST_BAR + 1]; // own checkers per distance (25 = bar)
+  unsigned char opp[DIST_BAR + 1]; // opponent's checkers (0 = his bar)
+};
+
+/*
+ * Chance (in 36ths) that a single checker hits a blot 'k' pips in front of
+ * it, ignoring blocked points
+ */
+unsigned char const HIT_CHANCE[] = {
+  0, 11, 12, 14, 15, 15, 17, 6, 6, 5, 3, 2, 3
+};
+
+enum {
+  MAX_HIT_DISTANCE = sizeof(HIT_CHANCE) / sizeof(HIT_CHANCE[0]) - 1,
+  BATCH_LANES = 8, // positions per 'board_batch' (16 bit lanes of a vector)
+};
+
+/* Feature weights, in equity per feature unit */
+double const W_PIP        = 0.012; // per pip of race lead
+double const W_ON_ROLL    = 4.0;   // being on roll is worth some pips
+double const W_MADE       = 0.03;  // per made point outside the home board
+double const W_HOME       = 0.05;  // per made home board point
+double const W_ANCHOR     = 0.04;  // per point made in the opponent's home
+double const W_PRIME      = 0.06;  // per point of the longest prime beyond 2
+double const W_CLOSED     = 0.04;  // per home point vs. checkers on the bar
+double const W_BLOT_PIPS  = 0.006; // per pip expected to be lost by blots
+double const W_BLOT_TEMPO = 0.08;  // per expected hit
+double const W_BAR        = 0.05;  // per own checker on the bar
+
+/* Racing to save the gammon */
+double const PIPS_PER_ROLL  = 8.17; // average pips moved per roll
+double const SAVE_PIPS      = 3.0;  // to bear off the first checker once home
+double const SPREAD_RACE    = 1.2;  // uncertainty (in rolls) of the race
+double const SPREAD_CONTACT = 5.0;  // ... with hits still possible
+
+/* Board features of one side, all integers (exact in any order) */
+enum feature {
+  F_HOME,        // made home board points
+  F_MADE,        // made points outside the home boards
+  F_ANCHOR,      // points made in the opponent's home board
+  F_PRIME,       // longest run of made points
+  F_CLOSED,      // made home board points, if the opponent is on the bar
+  F_SHOTS,       // 36ths of a hit, summed over all blots
+  F_SHOT_PIPS,   // ... times the pips the blot would lose
+  F_BAR,         // checkers on the bar
+  F_HOME_PIPS,   // pips to bring all checkers home
+  F_ESCAPE_PIPS, // pips to bring all checkers out of the opponent's home
+  NUM_FEATURES
+};
+
+typedef struct side_features {
+  int f[NUM_FEATURES];
+} side_features;
+
+template <signed char player>
+void
+view_of(game_state const * const state, side_view * const view)
+{
+  signed short int const * const board = state->board;
+
+  /* The opponent's distance 'e' is our distance 'DIST_BAR - e' */
+  view->own[0] = 0;
+  view->opp[0] = bar_count<-player>(state);
+
+  for (unsigned int dist = 1; dist <= POINTS; ++dist) {
+    signed short int const val = board[point_of<player>(dist)];
+
+    view->own[dist] = own_checkers<player>(val);
+    view->opp[dist] = own_checkers<-player>(val);
+  }
+
+  view->own[DIST_BAR] = bar_count<player>(state);
+  view->opp[DIST_BAR] = 0;
+}
+
+/* Features of the side described by 'view', one position at a time */
+void
+features_of(side_view const * const view, side_features * const out)
+{
+  int * const f = out->f;
+  unsigned int run = 0;
+
+  memset(f, 0, sizeof(out->f));
+
+  for (unsigned int dist = 1; dist <= POINTS; ++dist) {
+    unsigned int const num = view->own[dist];
+
+    if (num >= 2) {
+      f[dist <= HOME_POINTS ? F_HOME
+        : dist > POINTS - HOME_POINTS ? F_ANCHOR : F_MADE] += 1;
+      if (++run > (unsigned int) f[F_PRIME]) { f[F_PRIME] = run; }
+      continue;
+    }
+    run = 0;
+
+    if (num != 1) { continue; }
+
+    /* Blot: sum up the shots of all opponent's checkers behind it */
+    int chance = 0;
+
+    for (unsigned int k = 1; k <= MAX_HIT_DISTANCE && k <= dist; ++k)
+      if (view->opp[dist - k] > 0) { chance += HIT_CHANCE[k]; }
+
+    if (chance > 36) { chance = 36; }
+
+    f[F_SHOTS]     += chance;
+    f[F_SHOT_PIPS] += chance * (DIST_BAR - dist);
+  }
+
+  /* Closed home points are worth more if the opponent is on the bar */
+  if (view->opp[0] > 0) { f[F_CLOSED] = f[F_HOME]; }
+
+  f[F_BAR] = view->own[DIST_BAR];
+
+  for (unsigned int dist = HOME_POINTS + 1; dist <= DIST_BAR; ++dist) {
+    f[F_HOME_PIPS] += view->own[dist] * (dist - HOME_POINTS);
+    if (dist > POINTS - HOME_POINTS)
+      f[F_ESCAPE_PIPS] += view->own[dist] * (dist - (POINTS - HOME_POINTS));
+  }
+}
+
+/*
+ * Up to BATCH_LANES positions column-wise: one row per distance (of the
+ * side on roll in each position), one lane per position. The features of
+ * all lanes are computed at once, a row at a time.
+ */
+struct alignas(16) board_batch {
+  signed short int own[DIST_BAR + 1][BATCH_LANES]; // checkers of the side on roll
+  signed short int opp[DIST_BAR + 1][BATCH_LANES]; // of his opponent
+};
+
+/* Features of all lanes, one row per feature */
+struct alignas(16) batch_features {
+  signed short int f[NUM_FEATURES][BATCH_LANES];
+};
+
+/* Transpose the board of 'state' into 'lane' of 'batch' */
+template <signed char player>
+void
+batch_fill(board_batch * const batch, size_t const lane, game_state const * const state)
+{
+  signed short int const * const board = state->board;
+
+  batch->opp[0][lane] = bar_count<-player>(state);
+
+  for (unsigned int dist = 1; dist <= POINTS; ++dist) {
+    signed short int const val = board[point_of<player>(dist)];
+
+    batch->own[dist][lane] = own_checkers<player>(val);
+    batch->opp[dist][lane] = own_checkers<-player>(val);
+  }
+
+  batch->own[DIST_BAR][lane] = bar_count<player>(state);
+}
+
+/*
+ * 'features_of' for all lanes of 'batch', for the side on roll or (if
+ * 'mirrored') for his opponent, whose rows are the same in reverse.
+ */
+template <bool mirrored>
+void
+batch_features_of(board_batch const * const batch, batch_features * const out)
+{
+  auto own = [batch](unsigned int const dist) {
+    return (mirrored ? batch->opp[DIST_BAR - dist] : batch->own[dist]);
+  };
+  auto opp = [batch](unsigned int const dist) {
+    return (mirrored ? batch->own[DIST_BAR - dist] : batch->opp[dist]);
+  };
+
+#ifdef __SSE2__
+  __m128i const zero = _mm_setzero_si128(), one = _mm_set1_epi16(1);
+
+  /* Points the opponent holds, as lane masks */
+  __m128i occupied[DIST_BAR + 1];
+  for (unsigned int dist = 0; dist <= DIST_BAR; ++dist)
+    occupied[dist] = _mm_cmpgt_epi16(_mm_load_si128((__m128i const*) opp(dist)), zero);
+
+  __m128i home = zero, made = zero, anchor = zero, run = zero, prime = zero,
+          shots = zero, shot_pips = zero, home_pips = zero, escape_pips = zero;
+
+  for (unsigned int dist = 1; dist <= POINTS; ++dist) {
+    __m128i const num = _mm_load_si128((__m128i const*) own(dist));
+
+    /* Made points count one each (the mask is -1) and extend the run */
+    __m128i const is_made = _mm_cmpgt_epi16(num, one);
+
+    if (dist <= HOME_POINTS)                { home   = _mm_sub_epi16(home, is_made); }
+    else if (dist > POINTS - HOME_POINTS)   { anchor = _mm_sub_epi16(anchor, is_made); }
+    else                                    { made   = _mm_sub_epi16(made, is_made); }
+
+    run   = _mm_and_si128(_mm_add_epi16(run, one), is_made);
+    prime = _mm_max_epi16(prime, run);
+
+    /* Blots: the shots of all opponent's checkers behind */
+    __m128i chance = zero;
+
+    for (unsigned int k = 1; k <= MAX_HIT_DISTANCE && k <= dist; ++k)
+      chance = _mm_add_epi16(chance, _mm_and_si128(occupied[dist - k],
+                                                   _mm_set1_epi16(HIT_CHANCE[k])));
+
+    chance = _mm_and_si128(_mm_min_epi16(chance, _mm_set1_epi16(36)),
+                           _mm_cmpeq_epi16(num, one));
+
+    shots     = _mm_add_epi16(shots, chance);
+    shot_pips = _mm_add_epi16(shot_pips, _mm_mullo_epi16(chance, _mm_set1_epi16(DIST_BAR - dist)));
+
+    if (dist > HOME_POINTS)
+      home_pips = _mm_add_epi16(home_pips, _mm_mullo_epi16(num, _mm_set1_epi16(dist - HOME_POINTS)));
+    if (dist > POINTS - HOME_POINTS)
+      escape_pips = _mm_add_epi16(escape_pips,
+                                  _mm_mullo_epi16(num, _mm_set1_epi16(dist - (POINTS - HOME_POINTS))));
+  }
+
+  __m128i const bar = _mm_load_si128((__m128i const*) own(DIST_BAR));
+
+  home_pips   = _mm_add_epi16(home_pips, _mm_mullo_epi16(bar, _mm_set1_epi16(DIST_BAR - HOME_POINTS)));
+  escape_pips = _mm_add_epi16(escape_pips, _mm_mullo_epi16(bar, _mm_set1_epi16(HOME_POINTS + 1)));
+
+  __m128i * const f = (__m128i*) out->f;
+
+  f[F_HOME]        = home;
+  f[F_MADE]        = made;
+  f[F_ANCHOR]      = anchor;
+  f[F_PRIME]       = prime;
+  f[F_CLOSED]      = _mm_and_si128(home, occupied[0]);
+  f[F_SHOTS]       = shots;
+  f[F_SHOT_PIPS]   = shot_pips;
+  f[F_BAR]         = bar;
+  f[F_HOME_PIPS]   = home_pips;
+  f[F_ESCAPE_PIPS] = escape_pips;
+#else
+  for (size_t lane = 0; lane < BATCH_LANES; ++lane) {
+    side_view view;
+    side_features features;
+
+    for (unsigned int dist = 0; dist <= DIST_BAR; ++dist) {
+      view.own[dist] = own(dist)[lane];
+      view.opp[dist] = opp(dist)[lane];
+    }
+
+    features_of(&view, &features);
+    for (unsigned int cc = 0; cc < NUM_FEATURES; ++cc)
+      out->f[cc][lane] = features.f[cc];
+  }
+#endif
+}
+
+/* Positional score of a side from its features */
+double
+side_score(side_features const * const features)
+{
+  int const * const f = features->f;
+  double score = W_HOME * f[F_HOME] + W_MADE * f[F_MADE] + W_ANCHOR * f[F_ANCHOR];
+
+  if (f[F_PRIME] > 2) { score += W_PRIME * (f[F_PRIME] - 2); }
+
+  score += W_CLOSED * f[F_CLOSED];
+  score -= W_BLOT_TEMPO * f[F_SHOTS] / 36.0 + W_BLOT_PIPS * f[F_SHOT_PIPS] / 36.0;
+  score -= W_BAR * f[F_BAR];
+
+  return score;
+}
+
+double
+logistic(double const x)
+{
+  return 1.0 / (1.0 + exp(-x));
+}
+
+/*
+ * Fractions of the wins of side 'winner' that are gammons and backgammons:
+ * he has to bear off all his checkers before the loser gets his last
+ * checker home and one off (respectively, out of the winner's home board).
+ * Exact once the game is over.
+ */
+void
+gammon_fractions(position const * const pos, unsigned int const winner,
+                 side_features const * const loser, bool const on_roll,
+                 double const spread, double * const gammon, double * const backgammon)
+{
+  *gammon = *backgammon = 0.0;
+  if (pos->off[1 - winner] > 0) { return; }
+
+  /* Pips the loser needs to save the gammon and the backgammon */
+  double const save   = SAVE_PIPS + loser->f[F_HOME_PIPS],
+               escape = loser->f[F_ESCAPE_PIPS];
+
+  unsigned int const pips = pos->pips[winner];
+
+  if (pips == 0) {
+    *gammon     = 1.0;
+    *backgammon = (escape > 0.0 ? 1.0 : 0.0);
+    return;
+  }
+
+  /* Rolls the winner is behind, the side on roll is half a roll ahead */
+  double const rolls = pips / PIPS_PER_ROLL + (on_roll ? -0.5 : 0.5);
+
+  *gammon = logistic((save / PIPS_PER_ROLL - rolls) / spread);
+  if (escape > 0.0)
+    *backgammon = std::min(*gammon, logistic((escape / PIPS_PER_ROLL - rolls) / spread));
+}
+
+/* Outcomes of 'pos' from the features of the side on roll and his opponent */
+outcome
+combine(position const * const pos, side_features const * const own,
+        side_features const * const other)
+{
+  unsigned int const s = side_of(pos->state.player), o = 1 - s;
+  double win;
+
+  /* Finished games are races, too */
+  if (!pos->contact) {
+    win = race_win_probability(pos);
+  } else {
+    double const score =
+        W_PIP * ((double) pos->pips[o] - pos->pips[s] + W_ON_ROLL)
+      + side_score(own) - side_score(other);
+
+    win = 0.5 * (1.0 + tanh(score));
+  }
+
+  double const spread = (pos->contact ? SPREAD_CONTACT : SPREAD_RACE);
+  double gammon, backgammon, lose_gammon, lose_backgammon;
+
+  gammon_fractions(pos, s, other, true, spread, &gammon, &backgammon);
+  gammon_fractions(pos, o, own, false, spread, &lose_gammon, &lose_backgammon);
+
+  return outcome { win, win * gammon, win * backgammon,
+                   (1.0 - win) * lose_gammon, (1.0 - win) * lose_backgammon };
+}
+
+/* 'evaluate_outcome' for a known player on roll */
+template <signed char player>
+outcome
+evaluate(position const * const pos)
+{
+  side_view view;
+  side_features own, other;
+
+  view_of<player>(&pos->state, &view);
+  features_of(&view, &own);
+  view_of<-player>(&pos->state, &view);
+  features_of(&view, &other);
+
+  return combine(pos, &own, &other);
+}
+
+/* Lane 'lane' of 'batch' */
+void
+lane_features(batch_features const * const batch, size_t const lane,
+              side_features * const out)
+{
+  for (unsigned int cc = 0; cc < NUM_FEATURES; ++cc)
+    out->f[cc] = batch->f[cc][lane];
+}
+
+} // end anon namespace
+
+
+outcome
+evaluate_outcome(position const * const pos)
+{
+  assert(pos);
+
+  return (pos->state.player == PLAYER_BELOW ? evaluate<PLAYER_BELOW>(pos)
+                                            : evaluate<PLAYER_ABOVE>(pos));
+}
+
+double
+evaluate_position(position const * const pos)
+{
+  return outcome_equity(evaluate_outcome(pos));
+}
+
+void
+evaluate_batch(position const * const positions, size_t const count,
+               outcome * const results)
+{
+  assert((positions && results) || count == 0);
+
+  board_batch batch;
+  batch_features own, other;
+
+  for (size_t first = 0; first < count; first += BATCH_LANES) {
+    size_t const lanes = std::min<size_t>(BATCH_LANES, count - first);
+
+    /* Unused lanes hold empty boards */
+    memset(&batch, 0, sizeof(batch));
+
+    for (size_t lane = 0; lane < lanes; ++lane) {
+      game_state const * const state = &positions[first + lane].state;
+
+      if (state->player == PLAYER_BELOW)
+        batch_fill<PLAYER_BELOW>(&batch, lane, state);
+      else
+        batch_fill<PLAYER_ABOVE>(&batch, lane, state);
+    }
+
+    batch_features_of<false>(&batch, &own);
+    batch_features_of<true>(&batch, &other);
+
+    for (size_t lane = 0; lane < lanes; ++lane) {
+      side_features lane_own, lane_other;
+
+      lane_features(&own, lane, &lane_own);
+      lane_features(&other, lane, &lane_other);
+      results[first + lane] = combine(&positions[first + lane], &lane_own, &lane_other);
+    }
+  }
+}
+
+/* EOF */
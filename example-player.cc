@@ -7,6 +7,7 @@
 #include <mcp.h>
 #include <state.h>
 #include <state-internal.h> /* UNAVAILABLE for your player */
+#include <rules.h>          /* UNAVAILABLE for your player */
 
 
 static bool
@@ -68,16 +69,18 @@ main(int, char **) // ignore command line parameters
       /* Read move and leave loop if user ended the turn */
       if (! read_move_from_user(cur_move)) { break; }
 
-      /* Check whether the move is valid and retry if it is not */
+      /* Check whether the move is valid and retry if it is not (the board
+         is looked at from the player's side, not converted) */
+      rules_view const view = { &state };
       to_internal(cur_move, state.player, &int_move);
-      to_internal(&state, &int_state);
 
-      if (! check_move(&int_state, &int_move)) {
+      if (! rules_check_move(&view, &int_move, true)) {
         fputs("Invalid move! Retry...\n\n", stderr);
         continue;
       }
 
       /* Make our local game state represent the move */
+      to_internal(&state, &int_state);
       apply_move(&int_state, &int_move);
       from_internal(&int_state, &state);
 
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <position.h>
+
+/**
+ * Opening book
+ *
+ * The book file is a header followed by an array of fixed-size entries
+ * sorted by 'key'. It is mapped into memory read-only and searched in place,
+ * so opening it costs a single 'mmap' regardless of its size.
+ *
+ * Positions are stored canonically, i.e. with the player on roll as
+ * PLAYER_BELOW; the same entry serves both colours.
+ */
+
+enum {
+  BOOK_VERSION = 1,
+};
+
+/** File header */
+typedef struct book_header {
+  char     magic[8]; // "BGBOOK\0\0"
+  uint32_t version;  // BOOK_VERSION
+  uint32_t entries;  // number of entries following the header
+} book_header;
+
+/** One book move: the play for a position and a roll */
+typedef struct book_entry {
+  uint64_t key;               // 'book_key' of position and dice
+  uint8_t  dice[NUM_DICE];    // lower die first
+  uint8_t  num_moves;
+  uint8_t  reserved;
+  uint8_t  point_from[MAX_MOVES]; // canonical (PLAYER_BELOW) notation
+  uint8_t  roll[MAX_MOVES];
+  uint32_t padding;
+} book_entry;
+
+
+/** Lookup key for the position and dice in 'pos' */
+uint64_t book_key(position const * const pos);
+
+/**
+ * Map the book file at 'path'. Returns false, if the file is missing,
+ * malformed or larger than 'max_bytes'; the book is empty in this case.
+ */
+bool book_open(char const * const path, size_t const max_bytes = SIZE_MAX);
+
+/** Number of entries in the currently mapped book */
+size_t book_size();
+
+/**
+ * Look up the book move for the active player and his dice in 'pos'.
+ * Returns false, if the book has no (legal) move for it.
+ */
+bool book_lookup(position const * const pos, multi_move * const mmove);
+
+/**
+ * Build a book entry for 'mmove' played in 'pos'
+ */
+void book_entry_init(book_entry * const entry, position const * const pos,
+                     multi_move const * const mmove);
+
+/**
+ * Sort 'entries' and write them to a new book file at 'path'.
+ * Returns false on I/O errors.
+ */
+bool book_write(char const * const path, book_entry * const entries,
+                size_t const num_entries);
+
+/* EOF */
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stddef.h>
+
+/**
+ * Memory budget of the player
+ *
+ * Under contest rules the MCP limits the player's address space
+ * (RLIMIT_AS, see 'mcp -m/-M'); exceeding it makes allocations fail in the
+ * middle of a game. The budget takes the limit found at startup, subtracts
+ * what the process already uses and divides the rest among the large
+ * consumers by configurable ratios. Without a limit, BUDGET_DEFAULT bytes
+ * are divided instead.
+ *
+ * The ratios (percent) can be changed in the environment variable
+ * PLAYER_MEMORY, e.g.
+ *
+ *   PLAYER_MEMORY="tt=60,book=10,work=30"
+ *
+ * Pools left out share the rest in the proportions of their defaults:
+ * "tt=60" gives 20 percent each to 'book' and 'work'.
+ *
+ * 'work' is not allocated up front: it is left for the search's working
+ * memory (play lists, stack) and everything else that grows during a game.
+ */
+
+enum budget_pool {
+  POOL_TT,   // transposition table
+  POOL_BOOK, // mapping of the opening book
+  POOL_WORK, // headroom for the search
+  NUM_POOLS
+};
+
+enum {
+  BUDGET_MB      = 1 << 20,
+  BUDGET_DEFAULT = 256 * BUDGET_MB, // budget without an address space limit
+};
+
+typedef struct memory_budget {
+  size_t limit;            // address space limit (0: none)
+  size_t in_use;           // address space in use at startup
+  size_t pool[NUM_POOLS];  // bytes granted to each pool
+  unsigned int ratio[NUM_POOLS]; // percent of the available memory
+} memory_budget;
+
+/**
+ * Determine the budget from RLIMIT_AS, the memory in use and the ratios in
+ * PLAYER_MEMORY. Returns false, if that variable could not be parsed (the
+ * default ratios are used then).
+ */
+bool budget_init(memory_budget * const budget);
+
+/** Name of 'pool' as used in PLAYER_MEMORY */
+char const * budget_pool_name(budget_pool const pool);
+
+/* EOF */
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <position.h>
+
+/**
+ * Position corpus
+ *
+ * A large set of distinct positions (with the dice rolled), e.g. for
+ * benchmarks and training, collected from game logs or self-play by
+ * 'corpus-gen'. Like the opening book, the file is a header followed by an
+ * array of fixed-size entries that is mapped read-only and used in place.
+ *
+ * Positions are canonical: the player on roll is PLAYER_BELOW, so the same
+ * position seen from either colour is stored once. The entries are sorted
+ * by the game phase and then by 'key'; the header gives the range of
+ * entries of each phase.
+ */
+
+enum {
+  CORPUS_VERSION = 1,
+};
+
+/** File header */
+typedef struct corpus_header {
+  char     magic[8];                    // "BGCORPUS"
+  uint32_t version;                     // CORPUS_VERSION
+  uint32_t reserved;
+  uint64_t entries;                     // number of entries following the header
+  uint64_t phase_begin[NUM_PHASES + 1]; // first entry of each 'game_phase'
+} corpus_header;
+
+/** One position, seen by the player on roll */
+typedef struct corpus_entry {
+  uint64_t key;            // 'book_key' of position and dice
+  int8_t   points[POINTS]; // checkers on points 1 to 24 (own ones positive)
+  uint8_t  bar[2];         // checkers on the bar: own, opponent's
+  uint8_t  off[2];         // checkers borne off: own, opponent's
+  uint8_t  dice[NUM_DICE]; // lower die first
+  uint8_t  phase;          // 'game_phase'
+  uint8_t  reserved;
+} corpus_entry;
+
+/** A mapped corpus file */
+typedef struct corpus {
+  corpus_header const * header;
+  corpus_entry  const * entries;
+  size_t size; // bytes mapped
+} corpus;
+
+
+/** Build the canonical entry for the active player and his dice in 'pos' */
+void corpus_entry_init(corpus_entry * const entry, position const * const pos);
+
+/** Restore the position of 'entry' (PLAYER_BELOW is on roll) */
+void corpus_entry_position(corpus_entry const * const entry, position * const pos);
+
+/**
+ * Sort 'entries', drop duplicates and write them to a new corpus file at
+ * 'path'. Returns the number of distinct entries written or -1 on I/O
+ * errors.
+ */
+long corpus_write(char const * const path, corpus_entry * const entries,
+                  size_t const num_entries);
+
+/** Map the corpus file at 'path'. Returns false, if it is missing or malformed. */
+bool corpus_open(corpus * const c, char const * const path);
+
+/** Unmap 'c' */
+void corpus_close(corpus * const c);
+
+/** The entries of 'phase' in 'c' ('[*begin, *end)') */
+void corpus_phase(corpus const * const c, game_phase const phase,
+                  corpus_entry const ** const begin,
+                  corpus_entry const ** const end);
+
+/** Look up the active player and his dice in 'pos' (NULL if not in 'c') */
+corpus_entry const * corpus_find(corpus const * const c, position const * const pos);
+
+/* EOF */
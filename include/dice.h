@@ -0,0 +1,168 @@
+#pragma once
+
+#include <position.h>
+
+
+
+/*****************************************************************************
+ ** Tables about the dice, computed at compile time                         **
+ *****************************************************************************/
+
+enum {
+  DIE_FACES    = 6,  // faces of a single die
+  NUM_OUTCOMES = 36, // equally likely outcomes of rolling two dice
+  NUM_ROLLS    = 21, // distinct rolls (the order of the dice does not matter)
+};
+
+/** One of the 21 distinct rolls */
+typedef struct roll_info {
+  unsigned short dice[NUM_DICE];   // lower die first
+  unsigned char  weight;           // outcomes (of 36) resulting in this roll
+  unsigned char  num_steps;        // dice to play: four for doubles, else two
+  unsigned short steps[MAX_MOVES]; // dice in the order to play them, higher first
+} roll_info;
+
+/** Where a checker on distance 'dist' ends up after moving 'die' pips */
+enum step_kind {
+  STEP_MOVE,     // it stays on the board
+  STEP_OFF,      // it is borne off with the exact roll
+  STEP_OFF_HIGH, // it is borne off with a higher roll (rearmost checker only)
+};
+
+typedef struct step_info {
+  unsigned char to_point; // target point (POS_OFF when borne off)
+  unsigned char to_dist;  // target distance (0 when borne off)
+  unsigned char kind;     // 'step_kind'
+} step_info;
+
+
+namespace dice_detail {
+
+struct roll_table {
+  roll_info roll[NUM_ROLLS];
+  unsigned char index[DIE_FACES + 1][DIE_FACES + 1];
+};
+
+struct step_table {
+  step_info step[2][DIST_BAR + 1][DIE_FACES + 1];
+};
+
+constexpr roll_table
+make_rolls()
+{
+  roll_table t {};
+  unsigned int idx = 0;
+
+  for (unsigned short low = 1; low <= DIE_FACES; ++low) {
+    for (unsigned short high = low; high <= DIE_FACES; ++high, ++idx) {
+      roll_info & r = t.roll[idx];
+
+      r.dice[0]   = low;
+      r.dice[1]   = high;
+      r.weight    = (low == high ? 1 : 2);
+      r.num_steps = (low == high ? MAX_MOVES : NUM_DICE);
+      r.steps[0]  = high;
+      r.steps[1]  = low;
+      r.steps[2]  = (low == high ? low : 0);
+      r.steps[3]  = (low == high ? low : 0);
+
+      t.index[low][high] = t.index[high][low] = idx;
+    }
+  }
+  return t;
+}
+
+constexpr step_table
+make_steps()
+{
+  step_table t {};
+
+  for (unsigned int side = 0; side < 2; ++side) {
+    for (unsigned int dist = 1; dist <= DIST_BAR; ++dist) {
+      for (unsigned int die = 1; die <= DIE_FACES; ++die) {
+        step_info & s = t.step[side][dist][die];
+
+        if (dist > die) {
+          s.to_dist  = dist - die;
+          s.to_point = (side == 0 ? s.to_dist : POS_OFF - s.to_dist);
+          s.kind     = STEP_MOVE;
+        } else {
+          s.to_dist  = 0;
+          s.to_point = POS_OFF;
+          s.kind     = (dist == die ? STEP_OFF : STEP_OFF_HIGH);
+        }
+      }
+    }
+  }
+  return t;
+}
+
+constexpr unsigned int
+total_weight(roll_table const & t)
+{
+  unsigned int sum = 0;
+  for (roll_info const & r : t.roll) { sum += r.weight; }
+  return sum;
+}
+
+/*
+ * Static members of a class template have a single instance in the whole
+ * program (namespace scope constants would have one per translation unit,
+ * which the inline accessors below must not mix).
+ */
+template <typename unused = void>
+struct tables {
+  static constexpr roll_table rolls = make_rolls();
+  static constexpr step_table steps = make_steps();
+};
+
+template <typename unused> constexpr roll_table tables<unused>::rolls;
+template <typename unused> constexpr step_table tables<unused>::steps;
+
+} // end namespace dice_detail
+
+
+/** The 21 distinct rolls, ordered by their lower and then higher die */
+constexpr roll_info const *
+roll_begin()
+{
+  return dice_detail::tables<>::rolls.roll;
+}
+
+constexpr roll_info const *
+roll_end()
+{
+  return dice_detail::tables<>::rolls.roll + NUM_ROLLS;
+}
+
+/** The distinct roll for the dice 'd1' and 'd2' (in any order) */
+constexpr roll_info const &
+roll_of(unsigned short const d1, unsigned short const d2)
+{
+  return dice_detail::tables<>::rolls.roll[dice_detail::tables<>::rolls.index[d1][d2]];
+}
+
+/** Probability of 'roll' */
+constexpr double
+roll_probability(roll_info const & roll)
+{
+  return roll.weight / (double) NUM_OUTCOMES;
+}
+
+/**
+ * Target of moving a checker of the side 'side' ('side_of') on distance
+ * 'dist' by 'die' pips. Distance DIST_BAR gives the entry point from the bar.
+ */
+constexpr step_info const &
+step_of(unsigned int const side, unsigned int const dist, unsigned int const die)
+{
+  return dice_detail::tables<>::steps.step[side][dist][die];
+}
+
+
+static_assert(dice_detail::total_weight(dice_detail::tables<>::rolls) == NUM_OUTCOMES, "Roll weights");
+static_assert(roll_of(6, 6).num_steps == MAX_MOVES && roll_of(2, 5).steps[0] == 5, "Die sequences");
+static_assert(step_of(0, DIST_BAR, 3).to_point == 22 && step_of(1, DIST_BAR, 3).to_point == 3, "Entry points");
+static_assert(step_of(0, 4, 6).kind == STEP_OFF_HIGH && step_of(1, 13, 6).to_point == 18, "Steps");
+
+/* EOF */
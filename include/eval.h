@@ -0,0 +1,30 @@
+#pragma once
+
+#include <position.h>
+#include <outcome.h>
+
+/**
+ * Cheap static evaluation of 'pos' from the point of view of the player on
+ * roll ('pos->state.player'), before he has rolled.
+ *
+ * The chance to win comes from the race formulas in races and from a
+ * handful of weighted board features (pips, made points, anchors, primes
+ * and blot exposure) otherwise. The gammon and backgammon chances are
+ * estimated from the race to bring the last checkers home. Finished games
+ * are evaluated exactly.
+ */
+outcome evaluate_outcome(position const * const pos);
+
+/** Cubeless equity of 'evaluate_outcome' in [-3, 3] */
+double evaluate_position(position const * const pos);
+
+/**
+ * 'evaluate_outcome' of 'count' positions at once, e.g. all plays of a roll
+ * or positions gathered from many games ('results[i]' for 'positions[i]').
+ * The boards are stored column-wise, eight at a time, and their features
+ * computed with SSE2 for all of them in one pass over the points.
+ */
+void evaluate_batch(position const * const positions, size_t const count,
+                    outcome * const results);
+
+/* EOF */
@@ -3,6 +3,8 @@
 enum {
   CHILD_IN_FD  = 3,
   CHILD_OUT_FD = 4,
+  CHILD_SHM_FD  = 5, // the player's 'shm_channel' (only with FEATURE_SHM)
+  CHILD_BELL_FD = 6, // the MCP's 'shm_bell' (only with FEATURE_SHM)
 };
 
 /* EOF */
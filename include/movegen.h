@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+#include <position.h>
+
+/**
+ * A complete play (all checker moves of one turn) and its outcome
+ */
+typedef struct play {
+  multi_move mmove;  // the checker moves in 'state.h' notation
+  position   result; // position after the moves, same player still active
+} play;
+
+typedef std::vector<play> play_vector;
+
+
+/**
+ * Generate all legal plays for the active player and the dice in 'pos'.
+ *
+ * Plays leading to the same position are reported only once. Only plays
+ * using as many dice as possible are generated and, if just one die can be
+ * played, the higher one is preferred as required by the rules. If no
+ * checker can move at all, the empty play is the only result.
+ *
+ * The order of the plays depends on the position only.
+ */
+void generate_plays(position const * const pos, play_vector * const plays);
+
+/**
+ * Returns true, if the active player may move a checker from 'point_from'
+ * (POS_BAR or 1 to 24) by 'roll' pips in 'pos'
+ */
+bool can_move_checker(position const * const pos,
+                      unsigned short const point_from,
+                      unsigned short const roll);
+
+/* EOF */
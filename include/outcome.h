@@ -0,0 +1,59 @@
+#pragma once
+
+/**
+ * Distribution of the outcomes of a game
+ *
+ * A game ends in a single win, a gammon (the loser has not borne off any
+ * checker) or a backgammon (he still has a checker on the bar or in the
+ * winner's home board), worth 1, 2 or 3 points as reported by 'winner'.
+ * Instead of a single score the search carries the probabilities of all of
+ * them, seen by one player:
+ *
+ *   win             - he wins at all
+ *   win_gammon      - he wins a gammon or backgammon
+ *   win_backgammon  - he wins a backgammon
+ *   lose_gammon     - he loses a gammon or backgammon
+ *   lose_backgammon - he loses a backgammon
+ *
+ * Averaging over the rolls of a chance node and switching the point of
+ * view are linear, so the distributions are propagated exactly; only
+ * decisions collapse them into the cubeless money equity.
+ */
+typedef struct outcome {
+  double win;
+  double win_gammon;
+  double win_backgammon;
+  double lose_gammon;
+  double lose_backgammon;
+} outcome;
+
+
+/** The same distribution seen by the opponent */
+inline outcome
+outcome_flip(outcome const & o)
+{
+  return outcome { 1.0 - o.win, o.lose_gammon, o.lose_backgammon,
+                   o.win_gammon, o.win_backgammon };
+}
+
+/** Cubeless money equity in [-3, 3] (points won per game) */
+inline double
+outcome_equity(outcome const & o)
+{
+  return 2.0 * o.win - 1.0
+       + o.win_gammon - o.lose_gammon
+       + o.win_backgammon - o.lose_backgammon;
+}
+
+/** Add 'o' with the weight 'p' to 'sum' (e.g. the probability of a roll) */
+inline void
+outcome_add(outcome * const sum, outcome const & o, double const p)
+{
+  sum->win             += p * o.win;
+  sum->win_gammon      += p * o.win_gammon;
+  sum->win_backgammon  += p * o.win_backgammon;
+  sum->lose_gammon     += p * o.lose_gammon;
+  sum->lose_backgammon += p * o.lose_backgammon;
+}
+
+/* EOF */
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <state.h>
+
+/**
+ * In-process player plugins
+ *
+ * A player built as a shared library ('make my-player.so') exports the
+ * functions below with C linkage. Given a file name ending in ".so", the
+ * MCP loads it into its own process instead of forking and executing it,
+ * and calls it directly for every move: no pipes, no signals, no copies of
+ * the tables per process. Each player gets its own instance of the library
+ * (a separate link map), so two plugins do not share any state even if
+ * they are the same file. C libraries without 'dlmopen' (e.g. on Darwin)
+ * only allow one instance of each library.
+ *
+ * This is meant for benchmarks and self-play. Time and memory limits can
+ * not be enforced for a plugin, so tournaments keep using processes.
+ *
+ * The C library allows at most 15 extra link maps, and their thread-local
+ * storage has to fit into a small reserve. Beyond a few tables of plugins,
+ * raise the reserve, e.g.
+ *
+ *   GLIBC_TUNABLES=glibc.rtld.optional_static_tls=65536 ./mcp -j 7 ...
+ *
+ * All functions are called from one thread, never concurrently.
+ */
+
+enum {
+  PLAYER_PLUGIN_VERSION = 1,
+};
+
+extern "C" {
+
+/** PLAYER_PLUGIN_VERSION of the library (checked by the MCP first) */
+unsigned int player_plugin_version();
+
+/** Set up the player once before the first game. Returns false on errors. */
+bool player_init();
+
+/** A new game begins (the player's state is kept, e.g. its tables) */
+void player_new_game();
+
+/**
+ * Choose the move for the player and dice in 'state'. Returns false, if the
+ * player gives up (which the MCP treats like a crash).
+ */
+bool player_choose_move(game_state const * const state, multi_move * const mmove);
+
+/**
+ * Optional: think about the position after the last move chosen until
+ * 'interrupted' returns true (only called in the player's own process)
+ */
+void player_ponder(bool (* const interrupted)());
+
+typedef unsigned int (*player_plugin_version_fn)();
+typedef bool (*player_init_fn)();
+typedef void (*player_new_game_fn)();
+typedef bool (*player_choose_move_fn)(game_state const *, multi_move *);
+
+} // extern "C"
+
+/* EOF */
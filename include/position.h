@@ -0,0 +1,250 @@
+#pragma once
+
+#include <state.h>
+
+
+
+/*****************************************************************************
+ ** Player-side position with incrementally tracked race information        **
+ *****************************************************************************/
+
+/**
+ * Game state plus some bookkeeping that is updated with every checker move
+ * instead of being recomputed by scanning the board.
+ *
+ * All per-side arrays are indexed by 'side_of(player)'. Distances are
+ * measured from the side's own point of view: a checker on distance 'd'
+ * needs 'd' pips to be borne off, the bar is distance 25 and a side whose
+ * checkers are all borne off has a 'back' distance of 0.
+ */
+typedef struct position {
+  game_state state;
+
+  unsigned short int pips[2]; // pip count of both sides
+  unsigned char      back[2]; // distance of each side's rearmost checker
+  unsigned char      off[2];  // number of checkers borne off by each side
+  bool contact;               // may any checker still hit or be hit?
+} position;
+
+
+enum {
+  DIST_BAR = POINTS + 1, // distance of a checker on the bar
+};
+
+/** Index of 'player' into the per-side arrays of 'position' */
+inline unsigned int
+side_of(signed char const player)
+{
+  return (player == PLAYER_BELOW ? 0 : 1);
+}
+
+/** Distance of point 'pos' (1 to 24) from being borne off for 'player' */
+inline unsigned int
+distance_of(signed char const player, unsigned int const pos)
+{
+  return (player == PLAYER_BELOW ? pos : POS_OFF - pos);
+}
+
+/** Point (1 to 24) that is 'dist' pips away from being borne off */
+inline unsigned int
+point_of(signed char const player, unsigned int const dist)
+{
+  return (player == PLAYER_BELOW ? dist : POS_OFF - dist);
+}
+
+/** Number of checkers 'player' has on the bar */
+inline unsigned int
+bar_count(game_state const * const state, signed char const player)
+{
+  return (player == PLAYER_BELOW ? get_lower_bar(state->board[POS_BAR])
+                                 : get_higher_bar(state->board[POS_BAR]));
+}
+
+/** Number of checkers 'player' has on distance 'dist' (1 to DIST_BAR) */
+inline unsigned int
+checkers_at(game_state const * const state, signed char const player,
+            unsigned int const dist)
+{
+  if (dist == DIST_BAR) { return bar_count(state, player); }
+
+  int const val = state->board[point_of(player, dist)] * player;
+  return (val > 0 ? val : 0);
+}
+
+
+/*
+ * The helpers above for a side fixed at compile time, e.g.
+ * 'checkers_at<PLAYER_ABOVE>(state, dist)': the side folds into constant
+ * indices and comparisons, no multiplication by the player or branch on it
+ * is left. Code that walks the board (move generation, evaluation) is
+ * written once as a template over the side and dispatched once per call on
+ * 'state.player'.
+ */
+
+template <signed char player>
+constexpr unsigned int
+side_of()
+{
+  return (player == PLAYER_BELOW ? 0 : 1);
+}
+
+template <signed char player>
+constexpr unsigned int
+distance_of(unsigned int const pos)
+{
+  return (player == PLAYER_BELOW ? pos : POS_OFF - pos);
+}
+
+template <signed char player>
+constexpr unsigned int
+point_of(unsigned int const dist)
+{
+  return (player == PLAYER_BELOW ? dist : POS_OFF - dist);
+}
+
+template <signed char player>
+inline unsigned int
+bar_count(game_state const * const state)
+{
+  return (player == PLAYER_BELOW ? get_lower_bar(state->board[POS_BAR])
+                                 : get_higher_bar(state->board[POS_BAR]));
+}
+
+/** Checkers of 'player' on a point holding 'val' */
+template <signed char player>
+constexpr unsigned int
+own_checkers(signed short int const val)
+{
+  return (player == PLAYER_BELOW ? (val > 0 ? val : 0) : (val < 0 ? -val : 0));
+}
+
+/** May 'player' move onto a point holding 'val' (at most one opponent)? */
+template <signed char player>
+constexpr bool
+open_point(signed short int const val)
+{
+  return (player == PLAYER_BELOW ? val > -2 : val < 2);
+}
+
+template <signed char player>
+inline unsigned int
+checkers_at(game_state const * const state, unsigned int const dist)
+{
+  if (dist == DIST_BAR) { return bar_count<player>(state); }
+  return own_checkers<player>(state->board[point_of<player>(dist)]);
+}
+
+/** Returns true, if 'player' has all his checkers in the home board */
+inline bool
+position_bear_off_ready(position const * const pos, signed char const player)
+{
+  return pos->back[side_of(player)] <= HOME_POINTS;
+}
+
+/**
+ * Returns the point of the rearmost checker of 'player' or '0' if he does
+ * not have any checker left. Not meaningful while a checker is on the bar.
+ */
+inline unsigned int
+position_back_point(position const * const pos, signed char const player)
+{
+  unsigned int const back = pos->back[side_of(player)];
+  return (back == 0 ? 0 : point_of(player, back));
+}
+
+
+/** Stage of the game, used to adjust how much effort a decision deserves */
+enum game_phase {
+  PHASE_CONTACT,  // checkers may still hit each other
+  PHASE_RACE,     // no contact, but the active player cannot bear off yet
+  PHASE_BEAR_OFF, // no contact and the active player is bearing off
+  NUM_PHASES
+};
+
+/** Short names of the phases ("contact", "race", "bearoff") */
+extern char const * const PHASE_NAMES[NUM_PHASES];
+
+inline game_phase
+position_phase(position const * const pos)
+{
+  if (pos->contact) { return PHASE_CONTACT; }
+  return (position_bear_off_ready(pos, pos->state.player) ? PHASE_BEAR_OFF
+                                                          : PHASE_RACE);
+}
+
+/** Hand the turn over to the opponent (the dice are left untouched) */
+inline void
+position_switch_player(position * const pos)
+{
+  pos->state.player = -pos->state.player;
+}
+
+
+/**
+ * Establish 'pos' from 'state' (the only full scan of the board)
+ */
+void position_init(position * const pos, game_state const * const state);
+
+/**
+ * Move one checker of the active player from 'point_from' by 'roll' pips,
+ * hitting a blot or bearing off as needed, and update the bookkeeping.
+ *
+ * Note: The move is not validated, the caller has to make sure it is legal.
+ */
+void position_move(position * const pos, game_move const * const move);
+
+/** 'position_move' for a known active player ('pos->state.player') */
+template <signed char player>
+void position_move(position * const pos, game_move const * const move);
+
+/**
+ * 64 bit hash of the board and the active player (the dice are ignored)
+ */
+unsigned long long position_hash(position const * const pos);
+
+/**
+ * Like 'position_hash', but the board is mirrored such that the active
+ * player is always PLAYER_BELOW. Positions that only differ by the colour
+ * of the player on roll share the same canonical hash.
+ */
+unsigned long long position_canonical_hash(position const * const pos);
+
+/** Point 'point' (POS_BAR to POS_OFF) seen from the other side */
+inline unsigned short
+mirror_point(unsigned short const point)
+{
+  return (point == POS_BAR ? (unsigned short) POS_BAR : POS_OFF - point);
+}
+
+
+
+/*****************************************************************************
+ ** Race formulas (only meaningful if there is no contact)                  **
+ *****************************************************************************/
+
+/**
+ * Keith count of 'player': pip count plus penalties for stacked low points
+ * and gaps on the high home points.
+ */
+unsigned int race_keith_count(position const * const pos,
+                              signed char const player);
+
+/**
+ * Thorp count of 'player': pip count plus two per checker left on the board,
+ * plus one per checker on the ace point, minus one per occupied home point.
+ */
+unsigned int race_thorp_count(position const * const pos,
+                              signed char const player);
+
+/**
+ * Probability that the active player wins the race, estimated from the
+ * Keith counts of both sides with Kleinman's formula.
+ */
+double race_win_probability(position const * const pos);
+
+/**
+ * Cubeless race equity of the active player in [-1, 1]
+ */
+double race_equity(position const * const pos);
+
+/* EOF */
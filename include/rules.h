@@ -0,0 +1,147 @@
+#pragma once
+
+#include <state.h>
+
+/**
+ * Rules engine
+ *
+ * Source implementation of the rules the MCP enforces, equivalent to the
+ * shipped 'state-internal-*.s' (see 'rules-check'). 'rules-internal.cc'
+ * provides the API of 'state-internal.h' on top of these functions, so the
+ * MCP and the internal players can be linked against either implementation.
+ *
+ * No function allocates memory. Validating a play that uses all dice costs
+ * one pass over its moves; only shorter plays require a (bounded) search
+ * for longer ones to enforce the "maximal dice usage" rule.
+ *
+ * Like in 'state-internal.h', checking and applying single moves works on
+ * the internal board, where the active player moves 1->24, bears off from
+ * 19-24 and has positive counts. On the bar, the active player's checkers
+ * are in the lower two decimal places. 'player' keeps the general value, so
+ * hints can report points in the notation the player knows.
+ *
+ * Setting 'output' writes a hint explaining an invalid move (or a hit or a
+ * checker borne off) to STDERR, exactly like the assembler version does.
+ */
+
+/**
+ * Convert a single point (and its value) between the general and internal
+ * board. The conversion is its own inverse, i.e. it works both ways.
+ */
+void rules_to_internal(unsigned char    const         pos,
+                       signed short int const         val,
+                       signed char      const         player,
+                       unsigned char          * const int_pos,
+                       signed short int       * const int_val);
+
+/**
+ * Convert a state between the general and internal board (both ways). The
+ * points are flipped as three vectors where SSE2 is available.
+ */
+void rules_to_internal(game_state const * const state,
+                       game_state       * const int_state);
+
+/** Convert a move for 'player' between both notations (both ways) */
+void rules_to_internal(game_move const * const move,
+                       signed char       const player,
+                       game_move       * const int_move);
+
+/** Convert the first 'num_moves' moves of 'mmove' (both ways) */
+void rules_to_internal(multi_move const * const mmove,
+                       signed char        const player,
+                       multi_move       * const int_mmove);
+
+/**
+ * Read-only view of a state (general board) from the perspective of its
+ * active player, i.e. as if it was converted with 'rules_to_internal'. The
+ * board is not copied: each access maps the point instead. Pays off for
+ * code that only looks at a few points of a state (e.g. checking single
+ * moves), while code reading the whole board should convert it once.
+ */
+typedef struct rules_view {
+  game_state const * state;
+} rules_view;
+
+/** Checkers of the active player on the bar */
+inline unsigned short int
+rules_view_own_bar(rules_view const * const view)
+{
+  signed short int const bar = view->state->board[POS_BAR];
+  return (view->state->player == PLAYER_BELOW ? get_lower_bar(bar)
+                                              : get_higher_bar(bar));
+}
+
+/** Checkers of the opponent on the bar */
+inline unsigned short int
+rules_view_opp_bar(rules_view const * const view)
+{
+  signed short int const bar = view->state->board[POS_BAR];
+  return (view->state->player == PLAYER_BELOW ? get_higher_bar(bar)
+                                              : get_lower_bar(bar));
+}
+
+/** Value of the internal point 'int_pos' (including bar and off-board) */
+inline signed short int
+rules_view_at(rules_view const * const view, unsigned int const int_pos)
+{
+  game_state const * const s = view->state;
+
+  assert(int_pos <= POS_OFF);
+  if (int_pos == POS_BAR)
+    return rules_view_opp_bar(view) * 100 + rules_view_own_bar(view);
+
+  unsigned int const pos = (s->player == PLAYER_BELOW && int_pos <= POINTS
+                            ? POS_OFF - int_pos : int_pos);
+  return s->board[pos] * s->player;
+}
+
+/** Returns true, if one side has no checkers left (general board) */
+bool rules_is_final_state(game_state const * const state);
+
+/** Winner and type of victory as defined for 'winner' (general board) */
+int rules_winner(game_state const * const state);
+
+/** Returns true, if 'int_move' may be played (internal board) */
+bool rules_check_move(game_state const * const int_state,
+                      game_move  const * const int_move, bool const output);
+
+/** Like above, but on a view of a general state (the move is internal) */
+bool rules_check_move(rules_view const * const view,
+                      game_move  const * const int_move, bool const output);
+
+/** Apply the valid move 'int_move' (internal board) */
+void rules_apply_move(game_state * const int_state,
+                      game_move const * const int_move, bool const output);
+
+/**
+ * Number of dice the active player can use at most in 'int_state'. If
+ * 'mmove' is given, it receives one play using that many dice (internal
+ * notation).
+ */
+unsigned int rules_max_moves(game_state const * const int_state,
+                             multi_move       * const mmove);
+
+/**
+ * Check and apply a full move to 'state' (general board). Returns false and
+ * leaves 'state' alone, if the move is invalid.
+ */
+bool rules_apply_multi_move(game_state * const state,
+                            multi_move const * const mmove);
+
+/**
+ * Check many candidate moves for the same 'state' (general board) at once.
+ * 'legal[i]' tells whether 'mmoves[i]' is valid; 'results[i]' receives the
+ * state after it (or a copy of 'state', if it is invalid). Returns the
+ * number of valid candidates. No hints are written.
+ *
+ * Everything that does not depend on the candidate is computed once per
+ * batch: the internal board, the opponent's blocked points (which cannot
+ * change during a turn), the checkers still to be brought home before
+ * bearing off, and -- only if a candidate does not use all dice -- how many
+ * dice can be used and whether the higher die is playable.
+ */
+size_t rules_check_batch(game_state const * const state,
+                         multi_move const * const mmoves, size_t const count,
+                         bool * const legal, game_state * const results);
+
+/* EOF */
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <position.h>
+#include <timeman.h>
+
+/**
+ * Which candidates survive the cheap static ranking at the root: at most
+ * 'top_k' plays, and only those within 'margin' (in equity) of the best one
+ */
+typedef struct prune_limits {
+  unsigned int top_k;
+  double margin;
+} prune_limits;
+
+/** Tunable parameters of the move selection */
+typedef struct search_config {
+  prune_limits prune[NUM_PHASES]; // per 'game_phase' of the root position
+  time_budget time;               // limit of the deep search (see 'timeman.h')
+} search_config;
+
+
+/**
+ * Establish the default configuration in 'cfg' (without a time limit), then
+ * apply the overrides given in the environment variable PLAYER_PRUNE, e.g.
+ *
+ *   PLAYER_PRUNE="contact=8/0.2,race=4/0.1,bearoff=3/0.05"
+ *
+ * Returns false, if the variable could not be parsed (the defaults remain).
+ */
+bool search_config_init(search_config * const cfg);
+
+/**
+ * Explicitly seeded random number generator. The move selection itself is
+ * deterministic; randomness only enters through a generator passed in by
+ * the caller.
+ */
+typedef struct search_rng {
+  unsigned long long state;
+} search_rng;
+
+void search_rng_seed(search_rng * const rng, unsigned long long const seed);
+unsigned long long search_rng_next(search_rng * const rng);
+
+/** Work done by one 'search_root' call */
+typedef struct search_stats {
+  unsigned long plays;    // legal plays at the root
+  unsigned long searched; // plays searched one ply deeper
+  unsigned long deepened; // plays searched two plies deeper (with a time limit)
+  unsigned long nodes;    // plays evaluated statically (at all depths)
+  unsigned long tt_hits;  // replies found in the transposition table
+} search_stats;
+
+/**
+ * Choose a play for the active player and his dice in 'pos'.
+ *
+ * All legal plays are ranked by the static evaluation first; only the
+ * survivors of the pruning limits for the current game phase are searched
+ * one ply deeper (the opponent's best static reply to each of his rolls).
+ * With a time limit in 'cfg', close decisions are then searched another
+ * two plies deeper (our best static answer to each of our next rolls), as
+ * long as 'time_allot' grants. The search averages full outcome
+ * distributions (see 'outcome.h'); plays are compared by their cubeless
+ * equity, so gammons count double.
+ *
+ * Without a time limit, the result only depends on 'pos', 'cfg' and 'rng':
+ * plays with exactly the same score are told apart by 'rng' or, without
+ * one (NULL), by the order of generation. 'stats' (optional) receives the
+ * work done. Its node count includes the subtrees of transposition table
+ * hits, so it does not depend on earlier searches either.
+ */
+void search_root(position const * const pos, search_config const * const cfg,
+                 search_rng * const rng, multi_move * const mmove,
+                 search_stats * const stats);
+
+/**
+ * Cubeless equity of the best play for the player on roll and his dice in
+ * 'pos', as ranked by the static evaluation (the first stage of
+ * 'search_root'). The difference to its average over all rolls is the
+ * luck of the roll.
+ */
+double search_static_equity(position const * const pos);
+
+/**
+ * Think ahead while the opponent is on turn in 'pos' (after our play).
+ *
+ * For each of his rolls, the most likely ones first, his best static play
+ * is assumed and our reply to each of our rolls is searched (without the
+ * deep search of a time limit). Nothing is
+ * returned but the transposition table: when the predicted position comes
+ * up, the search finds most of its results there. 'interrupted' is polled
+ * between two searches; once it returns true, pondering stops early.
+ *
+ * Returns true, if all predicted positions were searched.
+ */
+bool search_ponder(position const * const pos, search_config const * const cfg,
+                   bool (* const interrupted)());
+
+/* EOF */
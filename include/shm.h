@@ -0,0 +1,99 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <state.h>
+
+/**
+ * Shared memory transport between the MCP and a player
+ *
+ * Offered by 'mcp -S' as the protocol extension FEATURE_SHM. Each player
+ * gets a channel of two single-producer/single-consumer rings, one for
+ * each direction, in a memory region shared with the MCP. Messages are
+ * copied into a ring as they are (text ending with a 0-byte); a reader
+ * that runs out of messages sleeps on a futex, which the writer only
+ * wakes if someone is actually sleeping.
+ *
+ * The MCP serves many players from one event loop. It cannot sleep on all
+ * their rings at once, so the players also ring a 'shm_bell' shared by
+ * all of them after each message.
+ *
+ * The transport needs Linux (memfd, futex). Elsewhere no region can be
+ * created, the MCP does not offer the extension and everybody uses pipes.
+ */
+
+enum {
+  SHM_SLOTS = 2, // messages in flight per direction (they strictly alternate)
+};
+
+/** Ring of messages from one process to another */
+typedef struct shm_ring {
+  uint32_t head;    // messages written so far (the futex word)
+  uint32_t tail;    // messages read so far
+  uint32_t waiting; // the reader sleeps (or is about to)
+  uint32_t len[SHM_SLOTS];
+  char     msg[SHM_SLOTS][MAX_MESSAGE_LEN];
+} shm_ring;
+
+/** Both directions between the MCP and one player */
+typedef struct shm_channel {
+  shm_ring to_player;
+  shm_ring from_player;
+} shm_channel;
+
+/** Doorbell of the MCP */
+typedef struct shm_bell {
+  uint32_t rings;   // messages sent to the MCP so far (the futex word)
+  uint32_t waiting; // the MCP sleeps (or is about to)
+} shm_bell;
+
+
+/**
+ * Create a shared memory region of 'size' bytes (all zero). Returns the
+ * mapping and its file descriptor in '*fd' (closed on exec), or NULL.
+ */
+void * shm_create(size_t const size, int * const fd);
+
+/** Map the region of 'size' bytes behind 'fd' (NULL if that failed) */
+void * shm_attach(int const fd, size_t const size);
+
+/** Unmap a region returned by the functions above */
+void shm_detach(void * const region, size_t const size);
+
+/**
+ * Append the message 'msg' of 'len' bytes (including the 0-byte) to 'ring'
+ * and wake its reader, if it sleeps. Returns false, if the ring is full or
+ * the message too long.
+ */
+bool shm_send(shm_ring * const ring, char const * const msg, size_t const len);
+
+/**
+ * Take the next message from 'ring' into 'buf' without waiting. Returns its
+ * length (including the 0-byte) or 0, if there is none.
+ */
+size_t shm_receive(shm_ring * const ring, char * const buf, size_t const size);
+
+/** Is a message waiting in 'ring'? */
+bool shm_pending(shm_ring const * const ring);
+
+/**
+ * Sleep until a message arrives in 'ring' or 'timeout_ms' passed. Returns
+ * true, if there is a message.
+ */
+bool shm_wait(shm_ring * const ring, int const timeout_ms);
+
+/** Current count of 'bell' (to be passed to 'shm_bell_wait') */
+uint32_t shm_bell_count(shm_bell const * const bell);
+
+/** Tell the MCP that a message is waiting */
+void shm_bell_ring(shm_bell * const bell);
+
+/**
+ * Sleep until 'bell' was rung after its count was 'seen' or 'timeout_ms'
+ * passed
+ */
+void shm_bell_wait(shm_bell * const bell, uint32_t const seen,
+                   int const timeout_ms);
+
+/* EOF */
@@ -2,6 +2,8 @@
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
 
 
 
@@ -157,6 +159,167 @@ bool deserialize_state(int const fd, game_state * const state);
 bool serialize_moves  (int const fd, multi_move const * const mmove);
 bool deserialize_moves(int const fd, multi_move       * const mmove);
 
+/** Upper bound for the length of any message (including the 0-byte) */
+enum { MAX_MESSAGE_LEN = 512 };
+
+/**
+ * Buffer-level variants of the functions above for callers doing their own
+ * (e.g. non-blocking) I/O. They neither read nor write, so they do not take
+ * part in enforcing the alternation of sending and receiving.
+ *
+ * 'format_state' and 'format_moves' return the length of the message in
+ * 'buf' including the terminating 0-byte, which has to be sent as well.
+ * 'format_moves' confirms the extensions in 'features' (see below).
+ */
+size_t format_state(char * const buf, size_t const size,
+                    game_state const * const state);
+bool   parse_state (char const * const msg, game_state * const state);
+size_t format_moves(char * const buf, size_t const size,
+                    multi_move const * const mmove, unsigned int const features);
+bool   parse_moves (char const * const msg, multi_move * const mmove,
+                    unsigned int * const features);
+
+
+/*****************************************************************************
+ ** Optional protocol extensions                                            **
+ *****************************************************************************/
+
+/**
+ * The MCP announces the extensions it supports to the player as a comma
+ * separated list of names in the environment variable MCP_FEATURES. The
+ * player confirms those it supports by sending them along with each of its
+ * moves ("2 | (13,2) (6,1) ; new-game"). Players and MCPs that do not know
+ * about extensions simply ignore them.
+ */
+enum {
+  /*
+   * "new-game": the player process is kept for the next game. Between two
+   * games the MCP sends a 'new game' message instead of a state; the player
+   * acknowledges it with an empty move.
+   */
+  FEATURE_NEW_GAME = 1 << 0,
+
+  /*
+   * "ponder": the player is not stopped after its move and may keep
+   * thinking while its opponent is on turn. It has to keep reading its
+   * input meanwhile; the time limit of its own moves is unchanged.
+   */
+  FEATURE_PONDER   = 1 << 1,
+
+  /*
+   * "shm": after its first answer that confirms it, the player exchanges
+   * all messages through shared memory instead of the pipes (see 'shm.h').
+   * It is not stopped between its turns either, just like a pondering one.
+   */
+  FEATURE_SHM      = 1 << 2,
+};
+
+/** Kinds of messages the player receives from the MCP */
+enum message_type {
+  MESSAGE_INVALID,
+  MESSAGE_STATE,
+  MESSAGE_NEW_GAME
+};
+
+/** Extensions announced by the MCP in the player's environment */
+unsigned int announced_features();
+
+/**
+ * Announce 'features' to a player (to be called by the MCP in the player's
+ * process right before it is executed)
+ */
+bool announce_features(unsigned int const features);
+
+/**
+ * The CPU time limits per move ('mcp -t/-T') are announced the same way, in
+ * seconds in the environment variable MCP_TIME ("soft,hard", e.g. "60,61").
+ * After the soft limit the player gets SIGXCPU, after the hard one it is
+ * killed. Returns false (and both 0), if the MCP set no limits.
+ */
+bool announced_time_limits(double * const soft, double * const hard);
+
+/** Announce the time limits to a player (like 'announce_features') */
+bool announce_time_limits(unsigned long const soft, unsigned long const hard);
+
+/** Like above, but confirm or learn the extensions in 'features' */
+bool serialize_moves  (int const fd, multi_move const * const mmove,
+                       unsigned int const features);
+bool deserialize_moves(int const fd, multi_move       * const mmove,
+                       unsigned int * const features);
+
+/**
+ * Tell the player that the current game is over and a new one begins.
+ * Only allowed, if the player confirmed FEATURE_NEW_GAME.
+ */
+bool serialize_new_game(int const fd);
+
+/** Buffer-level variant of 'serialize_new_game' (see 'format_state') */
+size_t format_new_game(char * const buf, size_t const size);
+
+/**
+ * Read the next message from the MCP: either a game state, which is
+ * stored in 'state', or a 'new game' notice.
+ */
+message_type deserialize_message(int const fd, game_state * const state);
+
+/**
+ * Has the MCP sent a message that was not read yet? Does not block (e.g.
+ * for players thinking while waiting).
+ */
+bool poll_message(int const fd);
+
+
+
+/*****************************************************************************
+ ** Several conversations in one process                                    **
+ *****************************************************************************/
+
+/**
+ * The functions above share one process-wide protocol context: a process
+ * is either the MCP or a player and talks to a single partner. In-process
+ * tournaments, trainers and the like keep one 'protocol_context' per
+ * connection instead and pass it to the variants below. They behave like
+ * the functions above, which merely use the process-wide context.
+ */
+enum protocol_role {
+  ROLE_NONE,   // nothing sent or received yet
+  ROLE_MCP,    // sends states, receives moves
+  ROLE_PLAYER  // receives states, sends moves
+};
+
+enum protocol_action {
+  ACTION_NONE,
+  ACTION_READ,
+  ACTION_SEND
+};
+
+typedef struct protocol_context {
+  protocol_role   role;        // taken on with the first message
+  protocol_action last_action; // sending and receiving alternate strictly
+  FILE * trace;                // log of the MCP's messages (NULL: none)
+
+  /* Player side of FEATURE_SHM (NULL while the pipes are used) */
+  struct shm_channel * shm;
+  struct shm_bell    * bell;
+} protocol_context;
+
+/** Establish a fresh context in 'ctx' (no role yet, tracing to stderr) */
+void protocol_init(protocol_context * const ctx);
+
+bool serialize_state  (protocol_context * const ctx, int const fd,
+                       game_state const * const state);
+bool deserialize_state(protocol_context * const ctx, int const fd,
+                       game_state * const state);
+bool serialize_new_game(protocol_context * const ctx, int const fd);
+bool serialize_moves  (protocol_context * const ctx, int const fd,
+                       multi_move const * const mmove,
+                       unsigned int const features);
+bool deserialize_moves(protocol_context * const ctx, int const fd,
+                       multi_move * const mmove,
+                       unsigned int * const features);
+message_type deserialize_message(protocol_context * const ctx, int const fd,
+                                 game_state * const state);
+
 
 /**
  * Establish the initial board in 'state'
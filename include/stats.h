@@ -0,0 +1,70 @@
+#pragma once
+
+#include <position.h>
+#include <search.h>
+
+/**
+ * Per move statistics of the player
+ *
+ * Switched on by setting the environment variable PLAYER_STATS to the name
+ * of a file. After each move one line of JSON is appended to that file
+ * (never to the MCP's pipes), e.g.
+ *
+ *   {"move":12,"player":1,"dice":[3,5],"phase":"contact","book":false,
+ *    "plies":[{"expanded":1,"generated":17},{"expanded":168,"generated":2875},
+ *             {"expanded":0,"generated":0}],
+ *    "evaluations":3042,"tt_probes":8,"tt_hits":2,"nodes":2892,"searched":8,
+ *    "deepened":0,
+ *    "us":{"generate":812,"evaluate":5210,"search":6301,"total":6420}}
+ *
+ * 'plies' counts the positions expanded by the move generator and the plays
+ * it returned at each depth of the search (the branching factor is their
+ * ratio). 'us' gives the time spent generating plays, evaluating them and
+ * in the whole search in microseconds; generation and evaluation are part
+ * of the search.
+ *
+ * While switched off, the counting functions return immediately.
+ */
+
+enum stats_phase {
+  STATS_GENERATE,
+  STATS_EVALUATE,
+  STATS_SEARCH,
+  NUM_STATS_PHASES
+};
+
+enum {
+  STATS_MAX_PLY = 3, // root plays, the replies and our answers (deep search)
+};
+
+/** Open the file named by PLAYER_STATS. Returns false, if that failed. */
+bool stats_init();
+
+/** Are statistics collected at all? */
+bool stats_enabled();
+
+/** Start collecting for the move to be chosen in 'pos' */
+void stats_begin_move(position const * const pos);
+
+/**
+ * Finish the current move and write its line. 'search' holds the summary
+ * of the search ('NULL' if the book was used).
+ */
+void stats_end_move(search_stats const * const search);
+
+/** The move generator expanded a position at 'ply' into 'plays' plays */
+void stats_count_generated(unsigned int const ply, unsigned long const plays);
+
+/** 'num' static evaluations */
+void stats_count_evaluations(unsigned long const num);
+
+/** A transposition table lookup (and whether it found the result) */
+void stats_count_probe(bool const hit);
+
+/** Current time in seconds if statistics are enabled, else 0 */
+double stats_clock();
+
+/** Add the time since 'start' (from 'stats_clock') to 'phase' */
+void stats_add_time(stats_phase const phase, double const start);
+
+/* EOF */
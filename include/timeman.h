@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <position.h>
+
+/**
+ * Time management of the player
+ *
+ * The MCP limits the time of each move ('mcp -t/-T', announced in
+ * MCP_TIME). Time left over on one move is lost, so the search does not
+ * save it up but spends it where it pays: forced and obvious plays are
+ * answered at once, close decisions between many plays in a contact
+ * position get the deep search, for up to TIME_MAX_SHARE of the limit.
+ *
+ * The environment variable PLAYER_TIME overrides the limit in seconds,
+ * e.g. for plugins, which the MCP does not limit:
+ *
+ *   PLAYER_TIME=2
+ *
+ * Without any limit there is no deep search, and the choice of a play does
+ * not depend on the speed of the machine.
+ */
+
+typedef struct time_budget {
+  double limit; // seconds per move (0: none)
+  double start; // clock when the current move began
+} time_budget;
+
+/**
+ * Take the limit from PLAYER_TIME or else from the MCP. Returns false, if
+ * PLAYER_TIME could not be parsed (the MCP's limit is used then).
+ */
+bool time_init(time_budget * const budget);
+
+/** The current move begins */
+void time_begin_move(time_budget * const budget);
+
+/** Seconds spent on the current move */
+double time_used(time_budget const * const budget);
+
+/**
+ * Seconds the current move deserves in 'phase' with 'plays' legal plays,
+ * the best two of which are 'gap' apart in equity (0 without a limit)
+ */
+double time_allot(time_budget const * const budget, game_phase const phase,
+                  size_t const plays, double const gap);
+
+/** Must the search stop at once (well before the limit)? */
+bool time_up(time_budget const * const budget);
+
+/* EOF */
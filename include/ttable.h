@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <outcome.h>
+
+/**
+ * Transposition table for search results, keyed by 'position_hash'.
+ *
+ * The table is a single process-wide array of 2^n entries; colliding
+ * entries simply replace each other. Results of different depths are
+ * different values, not refinements of each other: they are kept apart,
+ * and a probe only finds a result of exactly the requested depth.
+ */
+
+/**
+ * (Re)allocate the table with room for at least 'entries' results (rounded
+ * down to a power of two). All stored results are lost. Returns false, if
+ * the memory could not be allocated.
+ */
+bool tt_resize(size_t const entries);
+
+/**
+ * Allocate the largest table that fits into 'bytes', trying smaller ones if
+ * the memory is not available (down to a minimal table). Returns the
+ * number of bytes actually used, or 0 if even the minimal table failed.
+ */
+size_t tt_fit(size_t const bytes);
+
+/** Forget all stored results */
+void tt_clear();
+
+/**
+ * Look up the result for 'key' searched to exactly 'depth' plies along
+ * with the number of nodes it took to compute it. Returns false, if there
+ * is none.
+ */
+bool tt_probe(unsigned long long const key, unsigned int const depth,
+              outcome * const value, unsigned int * const nodes);
+
+/**
+ * Store the outcome distribution 'value' for 'key' searched to 'depth' plies. Values are
+ * kept exactly, so a hit gives the same result as searching again.
+ */
+void tt_store(unsigned long long const key, unsigned int const depth,
+              outcome const & value, unsigned int const nodes);
+
+/* EOF */
@@ -0,0 +1,227 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <map>
+
+#include <state.h>
+#include <position.h>
+#include <dice.h>
+#include <search.h>
+
+/*
+ * Luck-adjusted results of the games in MCP logs:
+ *
+ *   ./mcp -n 1000 my-player old-player 2> match.log
+ *   ./luck match.log
+ *
+ * The luck of a roll is the static equity of the best play with it
+ * ('search_static_equity') minus the average over all 21 rolls. The
+ * opening roll, which is never a double, is compared to the average of the
+ * 15 other ones. Subtracting the luck both players had from the result of
+ * a game leaves mostly what their plays earned. The adjusted results have
+ * the same mean (the luck averages out) but a much smaller variance, so
+ * far fewer games tell two players apart.
+ *
+ * The states come from the lines "> 1 4-1: ..." the MCP logs on stderr
+ * (also "[game] > ..." with 'mcp -j'), the results from its lines "Result
+ * of game n: points".
+ */
+
+namespace {
+
+/** Luck of both players in one game, and its result */
+typedef struct game_luck {
+  double luck[2];   // sum of the luck of P-1 and P1
+  unsigned rolls;   // rolls seen so far
+  int result;       // points won by P1 (negative: by P-1)
+  bool finished;
+} game_luck;
+
+typedef std::map<unsigned long, game_luck> game_map;
+
+/* Equity of the roll in 'pos' minus its average ('opening': without doubles) */
+double
+roll_luck(position const * const pos, bool const opening)
+{
+  position rolled = *pos;
+  double average = 0.0, weight = 0.0;
+
+  for (roll_info const * roll = roll_begin(); roll != roll_end(); ++roll) {
+    if (opening && roll->dice[0] == roll->dice[1]) { continue; }
+
+    double const p = (opening ? 1.0 : roll_probability(*roll));
+
+    rolled.state.dice[0] = roll->dice[0];
+    rolled.state.dice[1] = roll->dice[1];
+    average += p * search_static_equity(&rolled);
+    weight  += p;
+  }
+
+  return search_static_equity(pos) - average / weight;
+}
+
+/* Add the luck of the states and the results in the MCP log 'path' */
+bool
+read_log(game_map * const games, char const * const path)
+{
+  FILE * const f = (strcmp(path, "-") ? fopen(path, "r") : stdin);
+  if (!f) { return false; }
+
+  char line[MAX_MESSAGE_LEN];
+  unsigned long current = 1; // game of lines without "[game]"
+
+  while (fgets(line, sizeof(line), f)) {
+    char const * msg = line;
+    unsigned long game = current;
+    int points;
+
+    if (sscanf(msg, "Result of game %lu: %d", &game, &points) == 2) {
+      (*games)[game].result   = points;
+      (*games)[game].finished = true;
+      current = game + 1;
+      continue;
+    }
+
+    if (sscanf(msg, "== Game %lu of", &game) == 1) {
+      current = game;
+      continue;
+    }
+
+    if (*msg == '[') {
+      char * end;
+      game = strtoul(msg + 1, &end, 10);
+      if (*end != ']') { continue; }
+      msg = end + 1 + strspn(end + 1, " ");
+    }
+    if (strncmp(msg, "> ", 2)) { continue; }
+
+    game_state state;
+    if (!parse_state(msg + 2, &state)) { continue; }
+
+    position pos;
+    position_init(&pos, &state);
+
+    game_luck & g = (*games)[game];
+    g.luck[state.player == PLAYER_ABOVE ? 0 : 1] += roll_luck(&pos, g.rolls == 0);
+    g.rolls += 1;
+  }
+
+  bool const ok = !ferror(f);
+  if (f != stdin) { fclose(f); }
+  return ok;
+}
+
+/** Mean and standard deviation of a series */
+typedef struct series {
+  unsigned long n;
+  double sum;
+  double sum_sq;
+} series;
+
+void
+series_add(series * const s, double const x)
+{
+  s->n      += 1;
+  s->sum    += x;
+  s->sum_sq += x * x;
+}
+
+double
+series_mean(series const * const s)
+{
+  return (s->n ? s->sum / s->n : 0.0);
+}
+
+double
+series_stddev(series const * const s)
+{
+  if (s->n < 2) { return 0.0; }
+
+  double const mean = series_mean(s);
+  return sqrt((s->sum_sq - s->n * mean * mean) / (s->n - 1));
+}
+
+void
+usage(char const * const prog)
+{
+  fprintf(stderr, "Usage: %s [-v] mcp-log ...\n"
+                  "  -v      - Print the luck of each game\n"
+                  "  mcp-log - Standard error of the MCP ('-': stdin)\n",
+          prog);
+}
+
+} // end anon namespace
+
+
+int
+main(int argc, char **argv)
+{
+  bool verbose = false;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "v")) != -1) {
+    switch (opt) {
+    case 'v': verbose = true; break;
+    default:  usage(argv[0]); return 1;
+    }
+  }
+
+  if (optind >= argc) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  game_map games;
+
+  for (int arg = optind; arg < argc; ++arg) {
+    if (!read_log(&games, argv[arg])) {
+      perror(argv[arg]);
+      return 1;
+    }
+  }
+
+  /* Results seen by P1 as they are and without the luck of both players */
+  series raw = { 0, 0.0, 0.0 }, adjusted = { 0, 0.0, 0.0 };
+
+  for (game_map::value_type const & entry : games) {
+    game_luck const & g = entry.second;
+    if (!g.finished) { continue; }
+
+    double const luck = g.luck[1] - g.luck[0];
+
+    series_add(&raw, g.result);
+    series_add(&adjusted, g.result - luck);
+
+    if (verbose)
+      printf("Game %5lu: %+d points for P1, luck P-1 %+.3f, P1 %+.3f, "
+             "adjusted %+.3f\n",
+             entry.first, g.result, g.luck[0], g.luck[1], g.result - luck);
+  }
+
+  if (raw.n == 0) {
+    fprintf(stderr, "No finished games found.\n");
+    return 1;
+  }
+
+  double const se_raw = series_stddev(&raw) / sqrt(raw.n);
+  double const se_adjusted = series_stddev(&adjusted) / sqrt(adjusted.n);
+
+  printf("%lu games, points per game for P1:\n", raw.n);
+  printf("  raw           %+.3f +- %.3f (stddev %.3f)\n",
+         series_mean(&raw), se_raw, series_stddev(&raw));
+  printf("  luck-adjusted %+.3f +- %.3f (stddev %.3f)\n",
+         series_mean(&adjusted), se_adjusted, series_stddev(&adjusted));
+
+  /* Games needed for the same precision scale with the variance */
+  if (se_adjusted > 0.0)
+    printf("  variance ratio %.2f: as precise as %.0f raw games\n",
+           (se_raw * se_raw) / (se_adjusted * se_adjusted),
+           raw.n * (se_raw * se_raw) / (se_adjusted * se_adjusted));
+
+  return 0;
+}
+
+/* EOF */
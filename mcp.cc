@@ -1,7 +1,12 @@
 #include <assert.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -10,9 +15,24 @@
 #include <sys/time.h>
 #include <sys/resource.h>
 #include <signal.h>
+#include <time.h>
+
+/*
+ * The event loop uses epoll, timerfd and signalfd on Linux. Elsewhere it
+ * falls back to poll, a deadline per player and a self-pipe for SIGCHLD.
+ */
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#else
+#include <poll.h>
+#endif
 
 #include <state.h>
 #include <state-internal.h>
+#include <shm.h>
+#include <plugin.h>
 #include <mcp.h>
 
 enum exit_reason {
@@ -32,6 +52,8 @@ enum exit_reason {
 enum constants {
   PLAYERS = 2,
   NAME_MAX_LEN = 127,
+  MAX_EVENTS = 64,
+  SHM_POLL_MS = 10, // how long to sleep on the bell before looking at the fds
 };
 
 static const time_t ETERNITY = 0;
@@ -41,45 +63,133 @@ static time_t cpu_limit        = ETERNITY;
 static time_t cpu_limit_grace  = ETERNITY;
 static struct rlimit mem_limit = { RLIM_INFINITY, RLIM_INFINITY };
 
+/* Let players that support it think during their opponent's turn */
+static bool        ponder        = false;
+
+/* Offer players to exchange messages through shared memory */
+static bool        use_shm       = false;
+static shm_bell   *bell          = NULL;
+static int         bell_fd       = -1;
+static unsigned    shm_players   = 0; // players that switched to it
+
+/* Players loaded as plugins (see 'plugin.h') */
+static unsigned    plugins       = 0;
+
+/* Dice of a game depending only on the seed and its number (see 'sprt') */
+static bool               seeded    = false;
+static unsigned long long dice_seed = 0;
+
 static bool        debug         = false;
 static const char *valgrind_tool = NULL;
 
+/* What the MCP waits for from a player */
+enum player_status {
+  IDLE,     // nothing, it is not the player's turn
+  MOVING,   // a move for the state sent last
+  STARTING, // the acknowledgement of a new game
+};
+
 static struct player {
   int player;
-  volatile pid_t pid;
+  pid_t pid;
+  char const *executable;
+
+  /* Protocol extensions confirmed by the player */
+  unsigned int features;
+  enum player_status status;
 
   int pipe_from_player;
   int pipe_to_player;
 
-  volatile bool soft_timeout;
-  volatile bool hard_timeout;
+  /* Shared memory channel (if offered) and whether the player uses it */
+  shm_channel *shm;
+  int shm_fd;
+  bool shm_active;
+
+  /* Stopped with SIGSTOP until its next turn */
+  bool stopped;
+
+  /* In-process player: the library and its entry points (NULL otherwise) */
+  void *plugin;
+  player_new_game_fn new_game;
+  player_choose_move_fn choose_move;
+
+  /* Per-move time limit (armed while the player is not idle) */
+#ifdef __linux__
+  int timer;       // timerfd
+#else
+  double deadline; // on the monotonic clock (0: not armed)
+#endif
+  bool soft_timeout;
+
+  /*
+   * CPU time of the player process: spent on its own moves and -- when
+   * pondering -- during its opponent's turns (seconds). Without a CPU
+   * clock of the process (e.g. on Darwin), nothing is accounted.
+   */
+  clockid_t cpu_clock;
+  bool cpu_clocked;
+  double cpu_mark;     // CPU time when the player was stopped or woken last
+  double cpu_moving;
+  double cpu_pondering;
+
+  /* Message received so far (messages end with a 0-byte) */
+  char msg[MAX_MESSAGE_LEN];
+  size_t msg_len;
 
   char name[NAME_MAX_LEN + 1];
-} player[PLAYERS];
-
-static struct player * volatile current_player = NULL;
-
-
-/* Kill both players */
+} *player = NULL;
+
+/*
+ * A table is a pair of players, player[2 * t] (P-1) and player[2 * t + 1]
+ * (P1), playing one game after the other. All tables play at the same time.
+ */
+static struct table {
+  game_state state;
+  unsigned game;    // number of the game being played (counting from 1)
+  unsigned plies;
+  unsigned pending; // players yet to acknowledge the next game
+  unsigned long long dice; // generator of the dice (only if 'seeded')
+} *table = NULL;
+
+static unsigned num_tables = 1;
+
+/* Games of the match: started, finished and points won per player */
+static unsigned games = 1, games_started = 0, games_finished = 0;
+static unsigned points[PLAYERS] = { 0, 0 };
+static int result = DRAW; // exit code for the last game finished
+
+/* All file descriptors are multiplexed through one epoll instance */
+#ifdef __linux__
+static int epoll_fd  = -1;
+#else
+static struct pollfd *watched = NULL;        // ... or one poll set
+static uint64_t      *watched_source = NULL; // (the source of each fd)
+static unsigned       num_watched = 0;
+static int            signal_pipe = -1;      // written by the SIGCHLD handler
+#endif
+static int signal_fd = -1; // SIGCHLD arrived (signalfd or self-pipe)
+
+/* Signal mask to restore in the players */
+static sigset_t player_mask;
+
+/*
+ * Event sources are told apart by the 'u64' of their epoll data: the index
+ * of the player times two, plus one for its timer.
+ */
+static const uint64_t SIGNAL_EVENT = UINT64_MAX;
+
+
+/* Kill all players */
 static void kill_players()
 {
-  /* Disable SIGCHLD handling as both players are about to be killed */
-  struct sigaction sact;
-
-  if (sigemptyset(&sact.sa_mask)) { abort(); }
-  sact.sa_flags = 0;
-  sact.sa_handler = SIG_IGN;
-  if (sigaction(SIGCHLD, &sact, NULL) != 0) { abort(); }
-
   /* Wake and actually kill the players */
-  for (int i = 0; i < PLAYERS; i++) {
-    /* Any of the two players may not be initialized yet */
+  for (unsigned i = 0; player && i < PLAYERS * num_tables; i++) {
+    /* Any of the players may not be initialized yet */
     if (!player[i].pid) { continue; }
 
     kill(player[i].pid, SIGCONT);
     kill(player[i].pid, SIGTERM);
-    // waitpid(player[i].pid, NULL, 0);
-
   }
 }
 
@@ -97,86 +207,221 @@ exit_msg(unsigned r, const char *msg, ...)
   va_end(ap);
 }
 
-/* More convenient, yet still signal-safe version of 'write' */
-static ssize_t
-safe_write(int const fd, char const * const str, size_t max) {
-  const char *cur = str;
+/* Position of a player at its table: 0 (P-1) or 1 (P1) */
+static unsigned
+seat_of(struct player const * const p)
+{
+  return (p - player) % PLAYERS;
+}
 
-  while (*cur && max) { --max; ++cur; }
+static struct table *
+table_of(struct player const * const p)
+{
+  return &table[(p - player) / PLAYERS];
+}
 
-  size_t const len = cur - str;
-  size_t left = len;
+/*
+ * Move 'fd' above the descriptors the players expect, so setting those up
+ * in the child cannot overwrite it
+ */
+static int
+above_child_fds(int const fd)
+{
+  int const moved = fcntl(fd, F_DUPFD_CLOEXEC, CHILD_BELL_FD + 1);
 
-  while (left) { left -= write(fd, str, left); }
-  return len;
+  close(fd);
+  return moved;
 }
 
-/* Specify seconds = ETERNITY to disarm timer. */
-static void
-arm_timer(time_t const seconds)
+/* Pipe with both ends closed on exec */
+static int
+cloexec_pipe(int fds[2])
+{
+  if (pipe(fds) < 0) { return -1; }
+
+  if (fcntl(fds[0], F_SETFD, FD_CLOEXEC) < 0 || fcntl(fds[1], F_SETFD, FD_CLOEXEC) < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    return -1;
+  }
+  return 0;
+}
+
+#ifndef __linux__
+static double
+monotonic_time()
 {
-  struct itimerval t = { {0, 0}, {seconds, 0} };
-  if (setitimer(ITIMER_REAL, &t, NULL) < 0) { abort(); }
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
 }
+#endif
 
+/* Set up the event sources for 'num_tables' tables */
 static void
-alarm_handler(int const signum, siginfo_t *, void *)
+init_events()
 {
-  assert(signum == SIGALRM && "Unexpected signal");
+#ifdef __linux__
+  if ((epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0) { abort(); }
+#else
+  /* The players' pipes and the signal pipe */
+  watched        = (struct pollfd *) calloc(PLAYERS * num_tables + 1, sizeof(*watched));
+  watched_source = (uint64_t *) calloc(PLAYERS * num_tables + 1, sizeof(*watched_source));
+  if (!watched || !watched_source) { abort(); }
+#endif
+}
 
-  struct player *p = current_player;
-  assert(p && "No active player");
+/* Watch 'fd' for input, reported as 'source' */
+static void
+watch(int const fd, uint64_t const source)
+{
+#ifdef __linux__
+  struct epoll_event ev;
+
+  ev.events   = EPOLLIN;
+  ev.data.u64 = source;
+  if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) { abort(); }
+#else
+  watched[num_watched].fd     = fd;
+  watched[num_watched].events = POLLIN;
+  watched_source[num_watched] = source;
+  ++num_watched;
+#endif
+}
 
-  if (!p->soft_timeout) {
-    p->soft_timeout = true;
-    kill(p->pid, SIGXCPU);
-    arm_timer(cpu_limit_grace - cpu_limit);
-  } else {
-    p->hard_timeout = true;
-    kill(p->pid, SIGKILL);
-    safe_write(STDERR_FILENO, "Player timeout!\n", 16);
+/* Stop watching 'fd' */
+static void
+unwatch(int const fd)
+{
+#ifdef __linux__
+  epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+#else
+  for (unsigned i = 0; i < num_watched; ++i) {
+    if (watched[i].fd != fd) { continue; }
+
+    --num_watched;
+    watched[i]        = watched[num_watched];
+    watched_source[i] = watched_source[num_watched];
+    return;
   }
+#endif
 }
 
+/* Set up the player's timer (source: its index times two, plus one) */
 static void
-child_handler(int signum, siginfo_t *si, void *)
+init_timer(struct player * const p)
 {
-  assert(signum == si->si_signo && "Weird semantics");
-  assert(signum == SIGCHLD && "Unexpected signal");
-  assert((si->si_code != CLD_STOPPED) && (si->si_code != CLD_CONTINUED) && "Suppressed signal");
+#ifdef __linux__
+  p->timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (p->timer < 0) { abort(); }
+  watch(p->timer, (p - player) * 2 + 1);
+#else
+  p->deadline = 0.0;
+#endif
+}
+
+/* Specify seconds = ETERNITY to disarm the player's timer. */
+static void
+arm_timer(struct player * const p, time_t const seconds)
+{
+#ifdef __linux__
+  struct itimerspec t = { {0, 0}, {seconds, 0} };
+  if (timerfd_settime(p->timer, 0, &t, NULL) < 0) { abort(); }
+#else
+  p->deadline = (seconds == ETERNITY ? 0.0 : monotonic_time() + seconds);
+#endif
+}
+
+/* Has the player's timer expired (since it was armed)? */
+static bool
+timer_expired(struct player * const p)
+{
+#ifdef __linux__
+  uint64_t expirations;
+
+  /* The timer may have been disarmed after it expired */
+  return read(p->timer, &expirations, sizeof(expirations)) == sizeof(expirations);
+#else
+  if (p->deadline == 0.0 || monotonic_time() < p->deadline) { return false; }
 
-  /* Find the child that triggered the signal. */
-  size_t plid;
+  p->deadline = 0.0;
+  return true;
+#endif
+}
 
-  for (plid = 0; plid < 2; ++plid)
-    if (player[plid].pid == si->si_pid) { break; }
+/*
+ * Wait up to 'timeout_ms' (-1: no limit) for events and store their sources
+ * (at most MAX_EVENTS). Returns their number or -1 (see 'errno').
+ */
+static int
+wait_events(uint64_t * const sources, int const timeout_ms)
+{
+#ifdef __linux__
+  struct epoll_event events[MAX_EVENTS];
+  int const n = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout_ms);
 
-  assert(plid < 2 && "Signal from unknown child");
+  for (int i = 0; i < n; ++i) { sources[i] = events[i].data.u64; }
+  return n;
+#else
+  /* Wake up for the next deadline, too */
+  int timeout = timeout_ms;
+  double const now = monotonic_time();
 
+  for (unsigned i = 0; i < PLAYERS * num_tables; ++i) {
+    if (player[i].deadline == 0.0) { continue; }
 
-  /* Check if the child quit on its own */
-  if (si->si_code == CLD_EXITED) {
-    exit_msg(CRASH_0 + plid,         \
-             "'%s' left the game\n", \
-             player[plid].name);
+    double const left = player[i].deadline - now;
+    int const ms = (left > 0.0 ? (int) (left * 1000.0) + 1 : 0);
+
+    if (timeout < 0 || ms < timeout) { timeout = ms; }
   }
 
-  /* Otherwise, we only care if the child process was terminated */
-  if (si->si_code != CLD_KILLED) { return; }
+  if (poll(watched, num_watched, timeout) < 0) { return -1; }
+
+  /* Events not reported now are still there next time */
+  int n = 0;
+
+  for (unsigned i = 0; i < num_watched && n < MAX_EVENTS; ++i)
+    if (watched[i].revents) { sources[n++] = watched_source[i]; }
+
+  double const later = monotonic_time();
+
+  for (unsigned i = 0; i < PLAYERS * num_tables && n < MAX_EVENTS; ++i)
+    if (player[i].deadline != 0.0 && later >= player[i].deadline) { sources[n++] = i * 2 + 1; }
+
+  return n;
+#endif
+}
 
-  /* If the child was terminated by a signal (most common case), then
-     'si_status' contains the signal that caused termination. */
-  switch(si->si_status) {
+/* CPU time the player consumed so far (in seconds) */
+static double
+cpu_time(struct player const * const p)
+{
+  struct timespec ts;
 
-  case EXEC_FAILED:
-    exit_msg(EXEC_FAILED, "Unable to execute '%s'\n", player[plid].name);
-    break;
+  /* Processes that are gone keep their last reading */
+  if (!p->cpu_clocked || clock_gettime(p->cpu_clock, &ts) < 0) { return p->cpu_mark; }
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Log a message sent to ('>') or received from ('<') a player */
+static void
+trace(struct player const * const p, char const direction,
+      char const * const msg)
+{
+  if (num_tables > 1)
+    fprintf(stderr, "[%u] %c %s\n", table_of(p)->game, direction, msg);
+  else
+    fprintf(stderr, "%c %s\n", direction, msg);
+}
+
+static char const *
+signal_name(int const signum)
+{
+  switch(signum) {
 
-#define CASE(x) case x:                                  \
-                  exit_msg(CRASH_0 + plid,               \
-                  "'%s' got signal: %d (%s)\n",          \
-                  player[plid].name, si->si_status, #x); \
-                  break
+#define CASE(x) case x: return #x
 
     CASE(SIGHUP);  CASE(SIGINT);  CASE(SIGILL);  CASE(SIGABRT); CASE(SIGSEGV);
     CASE(SIGFPE);  CASE(SIGPIPE); CASE(SIGKILL); CASE(SIGALRM); CASE(SIGUSR1);
@@ -184,11 +429,22 @@ child_handler(int signum, siginfo_t *si, void *)
 #undef CASE
 
   default:
-    write(STDERR_FILENO, "Unexpected signal from child!\n", 30);
-    break;
+    return "unexpected";
   }
 }
 
+#ifndef __linux__
+/* Wake the event loop through the self-pipe */
+static void
+child_handler(int)
+{
+  int const saved = errno;
+
+  if (write(signal_pipe, "", 1) < 0) {} // a full pipe wakes it anyway
+  errno = saved;
+}
+#endif
+
 static void
 setup_signal_handlers()
 {
@@ -201,15 +457,96 @@ setup_signal_handlers()
   sact.sa_handler = SIG_IGN;
   if (sigaction(SIGPIPE, &sact, NULL) != 0) { abort(); }
 
-  /* Handle SIGALRM. */
-  sact.sa_sigaction = alarm_handler;
-  sact.sa_flags = SA_SIGINFO | SA_RESTART;
-  if (sigaction(SIGALRM, &sact, NULL) != 0) { abort(); }
+  /* Only report terminated children (no stop or resume events) */
+  sact.sa_flags = SA_NOCLDSTOP;
+
+#ifdef __linux__
+  sact.sa_handler = SIG_DFL;
+  if (sigaction(SIGCHLD, &sact, NULL) != 0) { abort(); }
+
+  /* SIGCHLD is not delivered but read from a signalfd by the event loop */
+  sigset_t mask;
+
+  if (sigemptyset(&mask) || sigaddset(&mask, SIGCHLD)) { abort(); }
+  if (sigprocmask(SIG_BLOCK, &mask, &player_mask) < 0) { abort(); }
 
-  /* Handle SIGCHLD (except for stop or resume events). */
-  sact.sa_sigaction = child_handler;
-  sact.sa_flags = SA_SIGINFO | SA_RESTART | SA_NOCLDSTOP;
+  if ((signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC)) < 0)
+    abort();
+#else
+  /* SIGCHLD writes to a pipe read by the event loop */
+  int fds[2];
+
+  if (cloexec_pipe(fds) < 0 || fcntl(fds[0], F_SETFL, O_NONBLOCK) < 0 ||
+      fcntl(fds[1], F_SETFL, O_NONBLOCK) < 0)
+    abort();
+  signal_fd   = fds[0];
+  signal_pipe = fds[1];
+
+  if (sigprocmask(SIG_SETMASK, NULL, &player_mask) < 0) { abort(); }
+
+  sact.sa_handler = child_handler;
   if (sigaction(SIGCHLD, &sact, NULL) != 0) { abort(); }
+#endif
+  watch(signal_fd, SIGNAL_EVENT);
+}
+
+/* Players named '*.so' are plugins */
+static bool
+is_plugin(char const * const executable)
+{
+  size_t const len = strlen(executable);
+  return (len > 3 && !strcmp(executable + len - 3, ".so"));
+}
+
+/* Load the plugin 'path' into its own link map and set it up */
+static bool
+load_plugin(char const * const path, struct player * const cur_player)
+{
+  char file[PATH_MAX];
+
+  /* Like 'execl', look for plain file names in the current directory */
+  snprintf(file, sizeof(file), "%s%s", (strchr(path, '/') ? "" : "./"), path);
+
+#ifdef LM_ID_NEWLM
+  void * const lib = dlmopen(LM_ID_NEWLM, file, RTLD_NOW | RTLD_LOCAL);
+#else
+  /* Without link maps of their own, instances would share their globals */
+  void * const loaded = dlopen(file, RTLD_NOW | RTLD_NOLOAD);
+  if (loaded) {
+    dlclose(loaded);
+    fprintf(stderr, "'%s' can only be loaded once on this system.\n", path);
+    return false;
+  }
+
+  void * const lib = dlopen(file, RTLD_NOW | RTLD_LOCAL);
+#endif
+  if (!lib) {
+    fprintf(stderr, "%s\n", dlerror());
+    return false;
+  }
+
+  player_plugin_version_fn const version =
+    (player_plugin_version_fn) dlsym(lib, "player_plugin_version");
+  player_init_fn const init = (player_init_fn) dlsym(lib, "player_init");
+
+  cur_player->new_game    = (player_new_game_fn) dlsym(lib, "player_new_game");
+  cur_player->choose_move = (player_choose_move_fn) dlsym(lib, "player_choose_move");
+
+  if (!version || version() != PLAYER_PLUGIN_VERSION || !init ||
+      !cur_player->new_game || !cur_player->choose_move || !init()) {
+    dlclose(lib);
+    return false;
+  }
+
+  strncpy(cur_player->name, path, sizeof(cur_player->name) - 1);
+
+  cur_player->plugin    = lib;
+  cur_player->features  = FEATURE_NEW_GAME; // plugins are never restarted
+  cur_player->status    = IDLE;
+  cur_player->cpu_clock   = CLOCK_THREAD_CPUTIME_ID;
+  cur_player->cpu_clocked = true;
+  ++plugins;
+  return true;
 }
 
 static bool
@@ -217,26 +554,50 @@ fork_player(char const * const executable, struct player * const cur_player)
 {
   assert(!cur_player->pid && "Player already started");
 
+  if (is_plugin(executable)) { return load_plugin(executable, cur_player); }
+
+  cur_player->executable = executable;
+  cur_player->features   = 0;
+  cur_player->status     = IDLE;
+  cur_player->msg_len    = 0;
+  cur_player->shm_active = false;
+
   enum { READ = 0, WRITE = 1 };
 
+  /* A fresh channel for each process (closed on exec like the pipes) */
+  if (use_shm) {
+    cur_player->shm = (shm_channel *) shm_create(sizeof(shm_channel),
+                                                 &cur_player->shm_fd);
+    if (!cur_player->shm) { return false; }
+
+    cur_player->shm_fd = above_child_fds(cur_player->shm_fd);
+    if (cur_player->shm_fd < 0) { return false; }
+  }
+
   int pipe_out[2], // Parent <- Child
       pipe_in[2];  // Parent -> Child
 
-  if ( pipe(pipe_out) || pipe(pipe_in) )  { return false; }
+  /* Close-on-exec: other players must not inherit our ends of the pipes */
+  if ( cloexec_pipe(pipe_out) || cloexec_pipe(pipe_in) )
+    return false;
   if ( (cur_player->pid = fork()) == -1 ) { abort(); }
-  strncpy(cur_player->name, executable, sizeof(cur_player->name));
+  strncpy(cur_player->name, executable, sizeof(cur_player->name) - 1);
 
   /* Child */
   if (cur_player->pid == 0) {
-    /* Close useless ends of pipes */
-    close(pipe_out[READ]);
-    close(pipe_in [WRITE]);
-
-    /* Associate useful ones with correct fds */
+    /* Associate useful ends with correct fds (the others are closed on exec) */
     dup2(pipe_in [READ],  CHILD_IN_FD);
     dup2(pipe_out[WRITE], CHILD_OUT_FD);
+    if (use_shm) {
+      dup2(cur_player->shm_fd, CHILD_SHM_FD);
+      dup2(bell_fd, CHILD_BELL_FD);
+    }
 
+    sigprocmask(SIG_SETMASK, &player_mask, NULL);
     setrlimit(RLIMIT_AS, &mem_limit);
+    announce_features(FEATURE_NEW_GAME | (ponder ? FEATURE_PONDER : 0) |
+                      (use_shm ? FEATURE_SHM : 0));
+    if (cpu_limit != ETERNITY) { announce_time_limits(cpu_limit, cpu_limit_grace); }
     execl(executable, executable, NULL);
 
     _exit(EXEC_FAILED);
@@ -245,23 +606,83 @@ fork_player(char const * const executable, struct player * const cur_player)
   else {
     /* Stop the cur_player until it is his turn */
     if (kill(cur_player->pid, SIGSTOP) < 0) { return false; }
+    cur_player->stopped = true;
+
+    /* Its CPU time is accounted from now on (if the system can) */
+#if defined(_POSIX_CPUTIME) && _POSIX_CPUTIME >= 0
+    cur_player->cpu_clocked =
+      (clock_getcpuclockid(cur_player->pid, &cur_player->cpu_clock) == 0);
+#else
+    cur_player->cpu_clocked = false;
+#endif
+    cur_player->cpu_mark = cpu_time(cur_player);
 
     /* Close useless ends of pipes */
     close(pipe_out[WRITE]);
     close(pipe_in [READ]);
+    if (use_shm) { close(cur_player->shm_fd); } // the mapping stays valid
 
     /* Remember the useful ones */
     cur_player->pipe_from_player = pipe_out[READ];
     cur_player->pipe_to_player   = pipe_in[WRITE];
+
+    /* Moves are read whenever they arrive, never waiting for them */
+    if (fcntl(cur_player->pipe_from_player, F_SETFL, O_NONBLOCK) < 0)
+      return false;
+    watch(cur_player->pipe_from_player, (cur_player - player) * 2);
   }
 
   return true;
 }
 
+/* Terminate a player on purpose, e.g. to restart it for the next game */
 static void
-throw_dice(unsigned short int * const dice)
+retire_player(struct player * const cur_player)
 {
-  assert(dice);
+  assert(cur_player->pid && "Player not started");
+
+  /* Its exit is reaped (and ignored) by the event loop */
+  kill(cur_player->pid, SIGCONT);
+  kill(cur_player->pid, SIGTERM);
+
+  unwatch(cur_player->pipe_from_player);
+  close(cur_player->pipe_from_player);
+  close(cur_player->pipe_to_player);
+
+  if (cur_player->shm_active) { --shm_players; }
+  shm_detach(cur_player->shm, sizeof(shm_channel));
+  cur_player->shm        = NULL;
+  cur_player->shm_active = false;
+
+  cur_player->pid = 0;
+}
+
+/* splitmix64: a die of the seeded generator 'state' */
+static unsigned short int
+roll_die(unsigned long long * const state)
+{
+  unsigned long long z = (*state += 0x9e3779b97f4a7c15ULL);
+
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return (z ^ (z >> 31)) % 6 + 1;
+}
+
+static void
+throw_dice(struct table * const t, unsigned short int * const dice)
+{
+  assert(t && dice);
+
+  /*
+   * The same seed and game number give the same dice, whichever player
+   * moves: replaying a game with swapped players gives each the dice the
+   * other one had (duplicate dice)
+   */
+  if (seeded) {
+    dice[0] = roll_die(&t->dice);
+    dice[1] = roll_die(&t->dice);
+    return;
+  }
 
   static bool init = false;
 
@@ -278,39 +699,435 @@ throw_dice(unsigned short int * const dice)
   dice[1] = (random() % 6) + 1;
 }
 
-static bool
-player_move(struct player           * const cur_player,
-            struct game_state const * const state,
-            multi_move              * const mmove)
+/* Collect the exit status of all children that terminated */
+static void
+reap_players()
+{
+  /* Pending signals are merged, so the reports are drained at once */
+  char reports[512]; // a multiple of 'struct signalfd_siginfo'
+
+  while (read(signal_fd, reports, sizeof(reports)) > 0) {}
+
+  pid_t pid;
+  int status;
+
+  while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+    /* Find the child that terminated. */
+    unsigned i;
+
+    for (i = 0; i < PLAYERS * num_tables; ++i)
+      if (player[i].pid == pid) { break; }
+
+    /* Players replaced between two games report their end, too */
+    if (i == PLAYERS * num_tables) { continue; }
+
+    unsigned const plid = seat_of(&player[i]);
+
+    if (WIFEXITED(status) && WEXITSTATUS(status) == EXEC_FAILED)
+      exit_msg(EXEC_FAILED, "Unable to execute '%s'\n", player[i].name);
+
+    /* Check if the child quit on its own */
+    if (WIFEXITED(status))
+      exit_msg(CRASH_0 + plid, "'%s' left the game\n", player[i].name);
+
+    if (WIFSIGNALED(status))
+      exit_msg(CRASH_0 + plid, "'%s' got signal: %d (%s)\n", player[i].name,
+               WTERMSIG(status), signal_name(WTERMSIG(status)));
+  }
+}
+
+/* Wake the player and send it a message; its time starts now */
+static void
+send_message(struct player * const cur_player, char const * const msg,
+             size_t const len, enum player_status const status)
 {
-  assert(!current_player && "Current player (still) set");
+  assert(cur_player->status == IDLE && "Player is busy");
 
-  bool succ;
+  unsigned const plid = seat_of(cur_player);
 
-  cur_player->hard_timeout = false;
+  cur_player->status       = status;
   cur_player->soft_timeout = false;
 
-  /* Arm timer with softlimit */
-  current_player = cur_player;
-  arm_timer(cpu_limit);
+  /* Plugins answer when the event loop calls them ('run_plugins') */
+  if (cur_player->plugin) {
+    trace(cur_player, '>', msg);
+    return;
+  }
 
-  if (!(debug || valgrind_tool) && kill(cur_player->pid, SIGCONT) < 0)
-    return false;
+  arm_timer(cur_player, cpu_limit);
+
+  /* Anything it used since its last answer was spent pondering */
+  double const now = cpu_time(cur_player);
+  cur_player->cpu_pondering += now - cur_player->cpu_mark;
+  cur_player->cpu_mark       = now;
 
-  succ = serialize_state(cur_player->pipe_to_player, state);
-  if (!succ || cur_player->hard_timeout) { return false; }
+  if (cur_player->stopped && !(debug || valgrind_tool) &&
+      kill(cur_player->pid, SIGCONT) < 0)
+    exit_msg(CRASH_0 + plid, "No move from player %d.\n", cur_player->player);
+  cur_player->stopped = false;
 
-  succ = deserialize_moves(cur_player->pipe_from_player, mmove);
-  if (!succ || cur_player->hard_timeout) { return false; }
+  trace(cur_player, '>', msg);
+
+  if (cur_player->shm_active) {
+    /* Only full, if the player does not follow the protocol */
+    if (!shm_send(&cur_player->shm->to_player, msg, len))
+      exit_msg(INVALID_MOVE_0 + plid, "Player %d does not read its messages.\n",
+               cur_player->player);
+    return;
+  }
+
+  /* Messages are shorter than PIPE_BUF and the pipe is drained by now */
+  if (write(cur_player->pipe_to_player, msg, len) != (ssize_t) len) {
+    reap_players(); // prefer the reason the player is gone, if known
+    exit_msg(CRASH_0 + plid, "No move from player %d.\n", cur_player->player);
+  }
+}
+
+/*
+ * The player answered: stop it and its timer. Players pondering during
+ * their opponent's turn or waiting on shared memory keep running (their
+ * CPU time is still recorded).
+ */
+static void
+stop_player(struct player * const cur_player)
+{
+  unsigned const plid = seat_of(cur_player);
+
+  if (cur_player->plugin) {
+    cur_player->status = IDLE;
+    return;
+  }
+
+  arm_timer(cur_player, ETERNITY);
+  cur_player->status = IDLE;
+
+  double const now = cpu_time(cur_player);
+  cur_player->cpu_moving += now - cur_player->cpu_mark;
+  cur_player->cpu_mark    = now;
+
+  if (cur_player->features & (FEATURE_PONDER | FEATURE_SHM)) { return; }
 
-  /* Stop cur_player and disarm timer. */
   if (!(debug || valgrind_tool) && kill(cur_player->pid, SIGSTOP) < 0)
-    return false;
+    exit_msg(CRASH_0 + plid, "No move from player %d.\n", cur_player->player);
+  cur_player->stopped = true;
+}
 
-  arm_timer(ETERNITY);
-  current_player = NULL;
+/* Throw the dice and ask the player on turn for its move */
+static void
+request_move(struct table * const t)
+{
+  game_state * const state = &t->state;
 
-  return true;
+  throw_dice(t, state->dice);
+
+  /* First move */
+  if (t->plies == 0) {
+    /* Doubles not allowed, because... */
+    while (state->dice[0] == state->dice[1])
+      throw_dice(t, state->dice);
+
+    /* ...the dice determine which player starts */
+    state->player = (state->dice[0] > state->dice[1] ? PLAYER_BELOW : PLAYER_ABOVE);
+  }
+
+  unsigned const player_no = (state->player == PLAYER_ABOVE ? 0 : 1);
+  struct player * const cur_player = &player[(t - table) * PLAYERS + player_no];
+
+  if (num_tables > 1)
+    printf("\n== Game %u, ply %2u: P%d '%s' ==\n",
+           t->game, ++t->plies, state->player, cur_player->name);
+  else
+    printf("\n== Ply %2u: P%d '%s' ==\n",
+           ++t->plies, state->player, cur_player->name);
+
+  if (debug) { print_state(state); }
+
+  char msg[MAX_MESSAGE_LEN];
+  size_t const len = format_state(msg, sizeof(msg), state);
+
+  send_message(cur_player, msg, len, MOVING);
+}
+
+/* Start the next game of the match at table 't' */
+static void
+start_game(struct table * const t)
+{
+  assert(games_started < games && "All games started");
+
+  t->game  = ++games_started;
+  t->plies = 0;
+  t->dice  = dice_seed ^ (t->game * 0xd1342543de82ef95ULL);
+
+  initialize_state(&t->state);
+  assert(!is_final_state(&t->state) && "State initialization failed");
+
+  if (games > 1) { fprintf(stderr, "\n== Game %u of %u ==\n", t->game, games); }
+
+  request_move(t);
+}
+
+/* Get the players ready for the next game: reuse the processes if possible */
+static void
+new_game(struct table * const t)
+{
+  t->pending = 0;
+
+  for (unsigned seat = 0; seat < PLAYERS; ++seat) {
+    struct player * const cur_player = &player[(t - table) * PLAYERS + seat];
+
+    if (cur_player->features & FEATURE_NEW_GAME) {
+      char msg[MAX_MESSAGE_LEN];
+      size_t const len = format_new_game(msg, sizeof(msg));
+
+      send_message(cur_player, msg, len, STARTING);
+      ++t->pending;
+      continue;
+    }
+
+    /* Players that cannot start over are restarted */
+    retire_player(cur_player);
+
+    if (!fork_player(cur_player->executable, cur_player))
+      exit_msg(EXEC_FAILED, "Unable to restart '%s'.\n", cur_player->name);
+  }
+
+  /* The game starts as soon as the last acknowledgement arrives */
+  if (t->pending == 0) { start_game(t); }
+}
+
+static void
+finish_game(struct table * const t)
+{
+  int const win = winner(&t->state);
+  unsigned const first = (t - table) * PLAYERS;
+
+  if (win == 0) {
+    fprintf(stderr, "Game ends in a DRAW.\n");
+    result = DRAW;
+  } else {
+    fprintf(stderr, "Player %d '%s' wins%s.\n", sign(win),
+     player[first + (win < 0 ? 0 : 1)].name,
+     (abs(win) == 3 ? " a backgammon" : (abs(win) == 2 ? " a gammon" : "")));
+    result = (win < 0 ? WIN_ABOVE : WIN_BELOW);
+    points[win < 0 ? 0 : 1] += abs(win);
+  }
+
+  /* For match managers: points won by P1 (negative: by P-1) */
+  fprintf(stderr, "Result of game %u: %d\n", t->game, win);
+
+  ++games_finished;
+
+  /* Keep the table busy while there are games left to play */
+  if (games_started < games) { new_game(t); }
+}
+
+/* Handle a complete message from a player */
+static void
+receive_message(struct player * const cur_player, char const * const msg)
+{
+  struct table * const t = table_of(cur_player);
+  unsigned const plid = seat_of(cur_player);
+  enum player_status const status = cur_player->status;
+
+  if (status == IDLE)
+    exit_msg(INVALID_MOVE_0 + plid, "Unexpected message from player %d.\n",
+             cur_player->player);
+
+  multi_move mmove;
+  bool const succ = parse_moves(msg, &mmove, &cur_player->features);
+
+  /* Extensions that were not offered do not count */
+  if (!use_shm) { cur_player->features &= ~FEATURE_SHM; }
+
+  stop_player(cur_player);
+  trace(cur_player, '<', msg);
+
+  /* From now on the player only listens to shared memory */
+  if ((cur_player->features & FEATURE_SHM) && !cur_player->shm_active) {
+    cur_player->shm_active = true;
+    ++shm_players;
+  }
+
+  /* The acknowledgement of a new game is an empty move */
+  if (status == STARTING) {
+    if (!succ || mmove.num_moves != 0)
+      exit_msg(CRASH_0 + plid, "'%s' did not acknowledge the new game.\n",
+               cur_player->name);
+
+    if (--t->pending == 0) { start_game(t); }
+    return;
+  }
+
+  if (!succ)
+    exit_msg(CRASH_0 + plid, "No move from player %d.\n", t->state.player);
+
+  printf("P%d moves.\n", t->state.player);
+
+  if (!apply_multi_move(&t->state, &mmove))
+    exit_msg(INVALID_MOVE_0 + plid,
+             "Invalid move from player %d.\n", t->state.player);
+
+  t->state.player *= -1; // switch active player
+
+  if (is_final_state(&t->state))
+    finish_game(t);
+  else
+    request_move(t);
+}
+
+/* Read whatever the player sent so far */
+static void
+read_player(struct player * const cur_player)
+{
+  unsigned const plid = seat_of(cur_player);
+
+  while (1) {
+    ssize_t const chars = read(cur_player->pipe_from_player,
+                               cur_player->msg + cur_player->msg_len,
+                               sizeof(cur_player->msg) - cur_player->msg_len);
+
+    if (chars < 0 && errno == EINTR) { continue; }
+    if (chars < 0) { return; } // EAGAIN: the rest is still on its way
+
+    /* End of file: the player is gone, its exit status tells why */
+    if (chars == 0) {
+      unwatch(cur_player->pipe_from_player);
+      return;
+    }
+
+    cur_player->msg_len += chars;
+
+    /* Handle all complete messages (they end with a 0-byte) */
+    char * end;
+
+    while ((end = (char *) memchr(cur_player->msg, '\0', cur_player->msg_len))) {
+      size_t const len = end - cur_player->msg + 1;
+      char msg[MAX_MESSAGE_LEN];
+
+      memcpy(msg, cur_player->msg, len);
+      cur_player->msg_len -= len;
+      memmove(cur_player->msg, cur_player->msg + len, cur_player->msg_len);
+
+      receive_message(cur_player, msg);
+    }
+
+    if (cur_player->msg_len == sizeof(cur_player->msg))
+      exit_msg(INVALID_MOVE_0 + plid, "Message from player %d too long.\n",
+               cur_player->player);
+  }
+}
+
+/* The player's time is up: warn it first, kill it after the grace time */
+static void
+timeout_player(struct player * const cur_player)
+{
+  if (!timer_expired(cur_player) || cur_player->status == IDLE) { return; }
+
+  if (!cur_player->soft_timeout && cpu_limit_grace > cpu_limit) {
+    cur_player->soft_timeout = true;
+    kill(cur_player->pid, SIGXCPU);
+    arm_timer(cur_player, cpu_limit_grace - cpu_limit);
+    return;
+  }
+
+  kill(cur_player->pid, SIGKILL);
+  fprintf(stderr, "Player timeout!\n");
+  exit_msg(CRASH_0 + seat_of(cur_player),
+           "No move from player %d.\n", cur_player->player);
+}
+
+/* Handle the messages waiting in shared memory. Returns true, if any. */
+static bool
+read_rings()
+{
+  bool any = false;
+
+  for (unsigned i = 0; i < PLAYERS * num_tables; ++i) {
+    char msg[MAX_MESSAGE_LEN];
+
+    /* Handling a message may replace the player (and its channel) */
+    while (player[i].shm_active &&
+           shm_receive(&player[i].shm->from_player, msg, sizeof(msg))) {
+      receive_message(&player[i], msg);
+      any = true;
+    }
+  }
+  return any;
+}
+
+/* Call the plugins that were sent a message. Returns true, if any. */
+static bool
+run_plugins()
+{
+  bool any = false;
+
+  for (unsigned i = 0; i < PLAYERS * num_tables; ++i) {
+    struct player * const cur_player = &player[i];
+
+    if (!cur_player->plugin || cur_player->status == IDLE) { continue; }
+
+    multi_move mmove;
+    bool ok = true;
+    double const start = cpu_time(cur_player);
+
+    initialize_multi_move(&mmove);
+
+    /* They are given the state itself, not the message */
+    if (cur_player->status == STARTING)
+      cur_player->new_game();
+    else
+      ok = cur_player->choose_move(&table_of(cur_player)->state, &mmove);
+
+    cur_player->cpu_moving += cpu_time(cur_player) - start;
+
+    /* The answer takes the same way as any other (an empty one is invalid) */
+    char msg[MAX_MESSAGE_LEN] = "";
+    if (ok) { format_moves(msg, sizeof(msg), &mmove, cur_player->features); }
+
+    receive_message(cur_player, msg);
+    any = true;
+  }
+  return any;
+}
+
+/* Drive all tables until every game of the match is finished */
+static void
+event_loop()
+{
+  uint64_t sources[MAX_EVENTS];
+
+  while (games_finished < games) {
+    /*
+     * Players on shared memory ring the bell instead of writing to a fd:
+     * look at the rings first, then at the fds without waiting, and only
+     * sleep on the bell if nothing happened. Timers and terminated players
+     * are noticed within SHM_POLL_MS.
+     */
+    uint32_t const rung = (shm_players ? shm_bell_count(bell) : 0);
+    bool const rings = (shm_players && read_rings());
+
+    /* Plugins are called right away; they may have work for each other */
+    bool const called = (plugins && run_plugins());
+
+    int const n = wait_events(sources, (shm_players || called ? 0 : -1));
+
+    if (n < 0 && errno == EINTR) { continue; }
+    if (n < 0) { abort(); }
+
+    if (shm_players && !rings && !called && n == 0)
+      shm_bell_wait(bell, rung, SHM_POLL_MS);
+
+    for (int i = 0; i < n; ++i) {
+      uint64_t const source = sources[i];
+
+      if (source == SIGNAL_EVENT)
+        reap_players();
+      else if (source % 2)
+        timeout_player(&player[source / 2]);
+      else
+        read_player(&player[source / 2]);
+    }
+  }
 }
 
 static void
@@ -318,10 +1135,23 @@ print_usage()
 {
   fprintf(stderr, "Usage: mcp [-t soft-player-time] [-m soft-player-mem]\n"
                   "           [-T hard-player-time] [-M hard-player-mem]\n"
+                  "           [-n games] [-j tables] [-s seed] [-P] [-S]\n"
                   //~ "           [-d] [-V valgrind-tool] [-p 1/-1]\n"
                   "           player1 player-1\n\n"
+                  "  player        - Executable or, if ending in '.so', a player\n"
+                  "                  plugin loaded into the MCP (no time and memory\n"
+                  "                  limits)\n"
                   "  player-time   - CPU time per turn in seconds\n"
-                  "  player-mem    - Memory limit per player in megabytes\n");
+                  "  player-mem    - Memory limit per player in megabytes\n"
+                  "  games         - Number of games to play (default: 1)\n"
+                  "  tables        - Number of games played at the same time,\n"
+                  "                  each by its own pair of players (default: 1)\n"
+                  "  seed          - The dice of each game only depend on the seed\n"
+                  "                  and the number of the game (default: random)\n"
+                  "  -P            - Players supporting it may ponder, i.e. think\n"
+                  "                  while their opponent is on turn\n"
+                  "  -S            - Players supporting it exchange messages\n"
+                  "                  through shared memory instead of pipes\n");
 }
 
 
@@ -331,12 +1161,17 @@ main(int argc, char **argv)
   fprintf(stderr, "Master Control Program\n");
 
   int opt;
-  while ((opt = getopt(argc, argv, "t:T:m:M:dV:p:")) != -1) {
+  while ((opt = getopt(argc, argv, "t:T:m:M:n:j:s:PSdV:p:")) != -1) {
     switch (opt) {
     case 't': cpu_limit       = strtoul(optarg, NULL, 0); break;
     case 'T': cpu_limit_grace = strtoul(optarg, NULL, 0); break;
     case 'm': mem_limit.rlim_cur = strtoul(optarg, NULL, 0) << 20; break;
     case 'M': mem_limit.rlim_max = strtoul(optarg, NULL, 0) << 20; break;
+    case 'n': games      = strtoul(optarg, NULL, 0); break;
+    case 'j': num_tables = strtoul(optarg, NULL, 0); break;
+    case 's': seeded = true; dice_seed = strtoull(optarg, NULL, 0); break;
+    case 'P': ponder = true; break;
+    case 'S': use_shm = true; break;
     //~ case 'd': debug = true; break;
     //~ case 'V': valgrind_tool = strdup(optarg); break;
     //~ case 'p': debug_player = strtoul(optarg, NULL, 0); break;
@@ -347,20 +1182,38 @@ main(int argc, char **argv)
   if ((cpu_limit != ETERNITY) && (cpu_limit_grace == ETERNITY))
     cpu_limit_grace = cpu_limit + DEFAULT_GRACE_TIME;
 
-  if (optind + 2 > argc) {
+  if (optind + 2 > argc || games == 0 || num_tables == 0) {
 usage:
     print_usage();
     exit(1);
   }
 
+  /* More tables than games would stay empty */
+  if (num_tables > games) { num_tables = games; }
+
+  init_events();
   setup_signal_handlers();
 
-  player[0].player = PLAYER_BELOW;
-  player[1].player = PLAYER_ABOVE;
+  /* One bell for all players, mapped into each of them (else: pipes) */
+  if (use_shm && !(bell = (shm_bell *) shm_create(sizeof(shm_bell), &bell_fd))) {
+    fprintf(stderr, "Shared memory is not available, using pipes.\n");
+    use_shm = false;
+  }
+  if (use_shm && (bell_fd = above_child_fds(bell_fd)) < 0)
+    exit_msg(EXEC_FAILED, "Unable to set up shared memory.\n");
+
+  player = (struct player *) calloc(PLAYERS * num_tables, sizeof(*player));
+  table  = (struct table *)  calloc(num_tables, sizeof(*table));
+  if (!player || !table) { abort(); }
+
+  for (unsigned i = 0; i < PLAYERS * num_tables; ++i) {
+    player[i].player = (seat_of(&player[i]) == 0 ? PLAYER_ABOVE : PLAYER_BELOW);
 
-  if (!fork_player(argv[optind],     &player[0]) ||
-      !fork_player(argv[optind + 1], &player[1]))
-    exit_msg(EXEC_FAILED, "Unable to fork players.\n");
+    init_timer(&player[i]);
+
+    if (!fork_player(argv[optind + seat_of(&player[i])], &player[i]))
+      exit_msg(EXEC_FAILED, "Unable to fork players.\n");
+  }
 
   fprintf(stderr, "'%s' (P-1) vs. '%s' (P1)\n", player[0].name, player[1].name);
 
@@ -370,57 +1223,34 @@ usage:
     fgets(buf, sizeof(buf), stdin);
   }
 
-  static struct game_state state;
-  static struct multi_move mmove;
-  static unsigned player_no;
-  static unsigned plies = 0;
-
-  initialize_state(&state);
-  assert(!is_final_state(&state) && "State initialization failed");
+  for (unsigned t = 0; t < num_tables; ++t)
+    start_game(&table[t]);
 
-  do {
-    throw_dice(state.dice);
+  event_loop();
 
-    /* First move */
-    if (plies == 0) {
-      /* Doubles not allowed, because... */
-      while (state.dice[0] == state.dice[1])
-        throw_dice(state.dice);
+  /* For a match, the points decide */
+  int ret = result;
 
-      /* ...the dice determine which player starts */
-      state.player = (state.dice[0] > state.dice[1] ? PLAYER_BELOW : PLAYER_ABOVE);
+  if (games > 1) {
+    fprintf(stderr, "\nMatch: '%s' (P-1) %u : %u '%s' (P1)\n",
+            player[0].name, points[0], points[1], player[1].name);
+    ret = (points[0] > points[1] ? WIN_ABOVE
+           : (points[0] < points[1] ? WIN_BELOW : DRAW));
+  }
+  /* Where the players' CPU time went */
+  if (ponder || use_shm || plugins) {
+    for (unsigned seat = 0; seat < PLAYERS; ++seat) {
+      double moving = 0.0, pondering = 0.0;
+
+      for (unsigned t = 0; t < num_tables; ++t) {
+        moving    += player[t * PLAYERS + seat].cpu_moving;
+        pondering += player[t * PLAYERS + seat].cpu_pondering;
+      }
+      fprintf(stderr, "CPU time of '%s' (P%d): %.2f s moving, %.2f s pondering\n",
+              player[seat].name, player[seat].player, moving, pondering);
     }
-
-    player_no = (state.player == PLAYER_ABOVE ? 0 : 1);
-    printf("\n== Ply %2u: P%d '%s' ==\n",
-           ++plies, state.player, player[player_no].name);
-
-    if (debug) { print_state(&state); }
-
-    if (!player_move(&player[player_no], &state, &mmove))
-      exit_msg(CRASH_0 + player_no,
-               "No move from player %d.\n", state.player);
-
-    printf("P%d moves.\n", state.player);
-
-    if (!apply_multi_move(&state, &mmove))
-      exit_msg(INVALID_MOVE_0 + player_no,
-               "Invalid move from player %d.\n", state.player);
-
-    state.player *= -1; // switch active player
-  } while (!is_final_state(&state));
-
-  int win = winner(&state);
-  int ret;
-  if (win == 0) {
-    fprintf(stderr, "Game ends in a DRAW.\n");
-    ret = DRAW;
-  } else {
-    fprintf(stderr, "Player %d '%s' wins%s.\n", sign(win),
-     player[(win < 0 ? 0 : 1)].name,
-     (abs(win) == 3 ? " a backgammon" : (abs(win) == 2 ? " a gammon" : "")));
-    ret = (win < 0 ? WIN_ABOVE : WIN_BELOW);
   }
+
   fprintf(stderr, "\n\nEnd of Line.\n");
 
   kill_players();
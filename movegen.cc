@@ -0,0 +1,190 @@
+#include <assert.h>
+#include <stddef.h>
+#include <unordered_set>
+
+#include <dice.h>
+#include <movegen.h>
+
+namespace {
+
+/* Bookkeeping shared by all branches of one 'generate_plays' call */
+struct generator {
+  explicit generator(play_vector & p) : plays(p), seen(), max_used(0) {}
+
+  play_vector & plays;
+  std::unordered_set<unsigned long long> seen; // hashes of reported results
+  unsigned int max_used;                       // dice used by reported plays
+};
+
+/* Can 'player' move a checker 'dist' pips from home by 'die' pips? */
+template <signed char player>
+bool
+can_move(position const * const pos, unsigned int const dist, unsigned int const die)
+{
+  game_state const * const state = &pos->state;
+
+  if (checkers_at<player>(state, dist) == 0) { return false; }
+
+  /* Checkers on the bar have to enter first */
+  if (dist != DIST_BAR && bar_count<player>(state) > 0) { return false; }
+
+  step_info const & step = step_of(side_of<player>(), dist, die);
+
+  /* Regular move: the target must not be blocked */
+  if (step.kind == STEP_MOVE)
+    return open_point<player>(state->board[step.to_point]);
+
+  /* Bearing off: exact roll, or a higher one for the rearmost checker */
+  if (pos->back[side_of<player>()] > HOME_POINTS) { return false; }
+  return (step.kind == STEP_OFF || dist == pos->back[side_of<player>()]);
+}
+
+void
+add_play(generator * const gen, position const * const pos,
+         multi_move const * const mmove)
+{
+  if (mmove->num_moves < gen->max_used) { return; }
+
+  /* Plays using more dice supersede all plays found so far */
+  if (mmove->num_moves > gen->max_used) {
+    gen->plays.clear();
+    gen->seen.clear();
+    gen->max_used = mmove->num_moves;
+  }
+
+  if (!gen->seen.insert(position_hash(pos)).second) { return; }
+
+  play p;
+  p.mmove  = *mmove;
+  p.result = *pos;
+  gen->plays.push_back(p);
+}
+
+/*
+ * Play dice[idx..num_dice) in every possible way. With doubles the checkers
+ * are moved in order of decreasing distance ('max_dist') as any other order
+ * only leads to the same positions again. Instantiated separately for
+ * both sides and for doubles, so the inner loop neither looks at the dice
+ * nor at the player.
+ */
+template <signed char player, bool doubles>
+void
+extend(generator * const gen, position const * const pos,
+       multi_move * const mmove, unsigned short const * const dice,
+       unsigned int const idx, unsigned int const max_dist)
+{
+  unsigned int const num_dice = (doubles ? MAX_MOVES : NUM_DICE);
+  bool moved = false;
+
+  if (idx < num_dice) {
+    unsigned int const die = dice[idx];
+    unsigned int dist = pos->back[side_of<player>()];
+
+    if (dist > max_dist) { dist = max_dist; }
+
+    for (; dist > 0; --dist) {
+      if (!can_move<player>(pos, dist, die)) { continue; }
+
+      game_move * const move = &mmove->moves[idx];
+      move->point_from = (dist == DIST_BAR ? (unsigned int) POS_BAR
+                                           : point_of<player>(dist));
+      move->roll = die;
+
+      position next = *pos;
+      position_move<player>(&next, move);
+      mmove->num_moves = idx + 1;
+
+      extend<player, doubles>(gen, &next, mmove, dice, idx + 1,
+                              (doubles ? dist : (unsigned int) DIST_BAR));
+      moved = true;
+    }
+  }
+
+  if (!moved) {
+    mmove->num_moves = idx;
+    add_play(gen, pos, mmove);
+  }
+}
+
+/* All plays of 'roll' by 'player', in both orders of the dice */
+template <signed char player>
+void
+extend_roll(generator * const gen, position const * const pos,
+            multi_move * const mmove, roll_info const & roll)
+{
+  if (roll.num_steps == MAX_MOVES) {
+    extend<player, true>(gen, pos, mmove, roll.steps, 0, DIST_BAR);
+    return;
+  }
+
+  unsigned short const reversed[NUM_DICE] = { roll.steps[1], roll.steps[0] };
+
+  extend<player, false>(gen, pos, mmove, roll.steps, 0, DIST_BAR);
+  extend<player, false>(gen, pos, mmove, reversed, 0, DIST_BAR);
+}
+
+} // end anon namespace
+
+
+bool
+can_move_checker(position const * const pos, unsigned short const point_from,
+                 unsigned short const roll)
+{
+  assert(pos);
+
+  if (point_from > POINTS || roll < 1 || roll > 6) { return false; }
+
+  signed char const player = pos->state.player;
+  unsigned int const dist = (point_from == POS_BAR ? (unsigned int) DIST_BAR
+                                                   : distance_of(player, point_from));
+
+  return (player == PLAYER_BELOW ? can_move<PLAYER_BELOW>(pos, dist, roll)
+                                 : can_move<PLAYER_ABOVE>(pos, dist, roll));
+}
+
+void
+generate_plays(position const * const pos, play_vector * const plays)
+{
+  assert(pos && plays);
+
+  unsigned short const * const dice = pos->state.dice;
+  multi_move mmove;
+
+  assert(dice[0] >= 1 && dice[0] <= 6 && dice[1] >= 1 && dice[1] <= 6);
+
+  plays->clear();
+  generator gen(*plays);
+  initialize_multi_move(&mmove);
+
+  roll_info const & roll = roll_of(dice[0], dice[1]);
+
+  /* Dispatch on the side once, the generator is instantiated for both */
+  if (pos->state.player == PLAYER_BELOW)
+    extend_roll<PLAYER_BELOW>(&gen, pos, &mmove, roll);
+  else
+    extend_roll<PLAYER_ABOVE>(&gen, pos, &mmove, roll);
+
+  if (roll.num_steps == MAX_MOVES) { return; }
+
+  /* If only one die can be played, it has to be the higher one if possible */
+  unsigned short const high = roll.steps[0];
+
+  if (gen.max_used == 1) {
+    bool high_playable = false;
+
+    for (play const & p : *plays)
+      if (p.mmove.moves[0].roll == high) { high_playable = true; }
+
+    if (high_playable) {
+      size_t keep = 0;
+
+      for (size_t cc = 0; cc < plays->size(); ++cc)
+        if ((*plays)[cc].mmove.moves[0].roll == high)
+          (*plays)[keep++] = (*plays)[cc];
+
+      plays->resize(keep);
+    }
+  }
+}
+
+/* EOF */
@@ -0,0 +1,346 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+
+#include <state.h>
+#include <rules.h>
+#include <position.h>
+#include <movegen.h>
+#include <dice.h>
+
+/*
+ * Perft for the move generator: starting from 'initialize_state', expand
+ * every position with every roll (or the rolls given) down to a depth and
+ * count the plays 'generate_plays' returns at each ply:
+ *
+ *   ./perft -d 2              all opening rolls and all replies
+ *   ./perft -d 4 -r 31,64     3-1, 6-4, then all rolls
+ *   ./perft -d 2 -c           the same, cross-checked with the rules engine
+ *
+ * The opening roll is never a double; like in the MCP, the player below
+ * starts if the first die is higher (all rolls: the lower die comes first).
+ *
+ * With -c the plays of every expanded position are compared with the rules
+ * the MCP enforces: each play has to be accepted by the rules engine with
+ * the same result, and the generator must find exactly the distinct
+ * positions reachable by the plays the rules engine accepts (found by
+ * trying all sequences of single moves). The timing of a run with -c
+ * includes the check, so measure without it.
+ */
+
+namespace {
+
+enum {
+  MAX_DEPTH = 8,
+};
+
+/** What a run has counted */
+typedef struct perft_counts {
+  unsigned long expanded[MAX_DEPTH]; // positions expanded with a roll, per ply
+  unsigned long plays[MAX_DEPTH];    // plays generated, per ply
+  unsigned long finished;            // plays that end the game before the last ply
+  unsigned long checked;             // positions cross-checked
+  unsigned long mismatches;
+} perft_counts;
+
+/** Rolls given on the command line, per ply (dice[0] == 0: all rolls) */
+typedef struct roll_spec {
+  unsigned short dice[MAX_DEPTH][NUM_DICE];
+} roll_spec;
+
+bool
+same_board(game_state const * const a, game_state const * const b)
+{
+  return memcmp(a->board, b->board, sizeof(a->board)) == 0;
+}
+
+bool
+board_less(game_state const & a, game_state const & b)
+{
+  return memcmp(a.board, b.board, sizeof(a.board)) < 0;
+}
+
+/* All sequences of valid single moves (including partial ones) */
+void
+collect_sequences(game_state const * const int_state,
+                  unsigned short const * const dice, unsigned int const num_dice,
+                  multi_move * const cur, std::vector<multi_move> * const seqs)
+{
+  seqs->push_back(*cur);
+  if (cur->num_moves == num_dice) { return; }
+
+  for (unsigned int d = 0; d < num_dice; ++d) {
+    if (dice[d] == 0 || (d && dice[d] == dice[d - 1])) { continue; }
+
+    unsigned short rest[MAX_MOVES];
+    for (unsigned int cc = 0; cc < num_dice; ++cc)
+      rest[cc] = (cc == d ? 0 : dice[cc]);
+
+    for (unsigned short from = POS_BAR; from <= POINTS; ++from) {
+      game_move const move = { from, dice[d] };
+      if (!rules_check_move(int_state, &move, false)) { continue; }
+
+      game_state next = *int_state;
+      rules_apply_move(&next, &move, false);
+
+      cur->moves[cur->num_moves++] = move;
+      collect_sequences(&next, rest, num_dice, cur, seqs);
+      cur->num_moves--;
+    }
+  }
+}
+
+void
+report(char const * const what, game_state const * const state,
+       multi_move const * const mmove, perft_counts * const counts)
+{
+  counts->mismatches++;
+  if (counts->mismatches > 10) { return; }
+
+  printf("MISMATCH: %s\n", what);
+  print_state(state);
+  if (mmove) {
+    printf("%hhu |", mmove->num_moves);
+    for (size_t cc = 0; cc < mmove->num_moves && cc < MAX_MOVES; ++cc)
+      printf(" (%hu,%hu)", mmove->moves[cc].point_from, mmove->moves[cc].roll);
+    printf("\n");
+  }
+}
+
+/* Compare the plays generated for 'pos' with the rules engine */
+void
+cross_check(position const * const pos, play_vector const & plays,
+            perft_counts * const counts)
+{
+  game_state const * const state = &pos->state;
+  counts->checked++;
+
+  /*
+   * Every generated play is legal and leads where the generator says
+   * ('rules_check_batch' agrees with 'rules_apply_multi_move', see
+   * 'rules-check', but writes no hints)
+   */
+  std::vector<multi_move> mmoves;
+  for (play const & p : plays) { mmoves.push_back(p.mmove); }
+
+  std::vector<game_state> generated(plays.size());
+  bool * const valid = new bool[plays.size()];
+
+  rules_check_batch(state, mmoves.data(), mmoves.size(), valid, generated.data());
+
+  for (size_t pp = 0; pp < plays.size(); ++pp) {
+    if (!valid[pp])
+      report("generated play rejected", state, &plays[pp].mmove, counts);
+    else if (!same_board(&generated[pp], &plays[pp].result.state))
+      report("generated play leads elsewhere", state, &plays[pp].mmove, counts);
+  }
+  delete[] valid;
+
+  /* The rules engine accepts no play leading anywhere else */
+  game_state int_state;
+  rules_to_internal(state, &int_state);
+
+  unsigned short const d0 = state->dice[0], d1 = state->dice[1];
+  unsigned short const dice[MAX_MOVES] = { std::min(d0, d1), std::max(d0, d1), d0, d1 };
+
+  std::vector<multi_move> seqs;
+  multi_move cur;
+  cur.num_moves = 0;
+  collect_sequences(&int_state, dice, (d0 == d1 ? MAX_MOVES : NUM_DICE), &cur, &seqs);
+
+  for (multi_move & m : seqs) {
+    rules_to_internal(&m, state->player, &cur);
+    m = cur;
+  }
+
+  std::vector<game_state> results(seqs.size());
+  bool * const legal = new bool[seqs.size()];
+
+  rules_check_batch(state, seqs.data(), seqs.size(), legal, results.data());
+
+  std::vector<game_state> accepted;
+  for (size_t cc = 0; cc < seqs.size(); ++cc)
+    if (legal[cc]) { accepted.push_back(results[cc]); }
+  delete[] legal;
+
+  std::sort(accepted.begin(), accepted.end(), board_less);
+  accepted.erase(std::unique(accepted.begin(), accepted.end(),
+                             [](game_state const & a, game_state const & b) {
+                               return same_board(&a, &b);
+                             }),
+                 accepted.end());
+
+  std::sort(generated.begin(), generated.end(), board_less);
+  bool const duplicates =
+    std::adjacent_find(generated.begin(), generated.end(),
+                       [](game_state const & a, game_state const & b) {
+                         return same_board(&a, &b);
+                       }) != generated.end();
+
+  if (duplicates)
+    report("generated plays lead to the same position", state, NULL, counts);
+  else if (generated.size() != accepted.size())
+    report("number of distinct plays differs from the rules", state, NULL, counts);
+  else if (!std::equal(generated.begin(), generated.end(), accepted.begin(),
+                       [](game_state const & a, game_state const & b) {
+                         return same_board(&a, &b);
+                       }))
+    report("plays differ from the rules", state, NULL, counts);
+}
+
+/* Expand 'pos' with the rolls of 'ply' and recurse down to 'depth' */
+void
+perft(position const * const pos, unsigned int const ply, unsigned int const depth,
+      roll_spec const * const spec, bool const check,
+      std::vector<play_vector> * const plays, perft_counts * const counts)
+{
+  position rolled = *pos;
+  play_vector & cur = (*plays)[ply];
+  unsigned short const * const given = spec->dice[ply];
+
+  for (roll_info const * roll = roll_begin(); roll != roll_end(); ++roll) {
+    if (given[0]) {
+      if (&roll_of(given[0], given[1]) != roll) { continue; }
+      rolled.state.dice[0] = given[0];
+      rolled.state.dice[1] = given[1];
+    } else {
+      if (ply == 0 && roll->dice[0] == roll->dice[1]) { continue; }
+      rolled.state.dice[0] = roll->dice[0];
+      rolled.state.dice[1] = roll->dice[1];
+    }
+
+    /* The opening roll decides who starts */
+    if (ply == 0) {
+      rolled.state.player = (rolled.state.dice[0] > rolled.state.dice[1]
+                             ? PLAYER_BELOW : PLAYER_ABOVE);
+    }
+
+    generate_plays(&rolled, &cur);
+    counts->expanded[ply]++;
+    counts->plays[ply] += cur.size();
+
+    if (check) { cross_check(&rolled, cur, counts); }
+    if (ply + 1 == depth) { continue; }
+
+    for (size_t pp = 0; pp < cur.size(); ++pp) {
+      position next = cur[pp].result;
+
+      if (next.off[side_of(next.state.player)] == NUM_CHECKERS) {
+        counts->finished++;
+        continue;
+      }
+
+      position_switch_player(&next);
+      perft(&next, ply + 1, depth, spec, check, plays, counts);
+    }
+  }
+}
+
+/* Parse "31,64,55" into 'spec' */
+bool
+parse_rolls(char const * str, roll_spec * const spec)
+{
+  for (unsigned int ply = 0; *str; ++ply) {
+    if (ply >= MAX_DEPTH || str[0] < '1' || str[0] > '6' ||
+        str[1] < '1' || str[1] > '6')
+      return false;
+
+    spec->dice[ply][0] = str[0] - '0';
+    spec->dice[ply][1] = str[1] - '0';
+    if (ply == 0 && str[0] == str[1]) { return false; }
+
+    str += 2;
+    if (*str == ',') { ++str; }
+  }
+  return true;
+}
+
+double
+seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void
+usage(char const * const prog)
+{
+  fprintf(stderr, "Usage: %s [-d depth] [-r rolls] [-c]\n"
+                  "  -d depth - Plies to expand (default: 2, at most %d)\n"
+                  "  -r rolls - Rolls of the first plies, e.g. '31,64' (others: all)\n"
+                  "  -c       - Cross-check all plays with the rules engine\n",
+          prog, MAX_DEPTH);
+}
+
+} // end anon namespace
+
+
+int
+main(int argc, char **argv)
+{
+  unsigned int depth = 2;
+  bool check = false;
+  roll_spec spec;
+  int opt;
+
+  memset(&spec, 0, sizeof(spec));
+
+  while ((opt = getopt(argc, argv, "d:r:c")) != -1) {
+    switch (opt) {
+    case 'd': depth = strtoul(optarg, NULL, 0); break;
+    case 'r':
+      if (!parse_rolls(optarg, &spec)) {
+        fprintf(stderr, "Invalid rolls '%s' (the first one must not be a double).\n", optarg);
+        return 1;
+      }
+      break;
+    case 'c': check = true; break;
+    default:  usage(argv[0]); return 1;
+    }
+  }
+
+  if (optind != argc || depth == 0 || depth > MAX_DEPTH) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  game_state start;
+  position pos;
+
+  initialize_state(&start);
+  position_init(&pos, &start);
+
+  perft_counts counts;
+  memset(&counts, 0, sizeof(counts));
+  std::vector<play_vector> plays(depth);
+
+  double const begin = seconds();
+  perft(&pos, 0, depth, &spec, check, &plays, &counts);
+  double const elapsed = seconds() - begin;
+
+  for (unsigned int ply = 0; ply < depth; ++ply)
+    printf("ply %u: %12lu positions x rolls, %13lu plays (%.2f per roll)\n",
+           ply + 1, counts.expanded[ply], counts.plays[ply],
+           (counts.expanded[ply] ? (double) counts.plays[ply] / counts.expanded[ply] : 0.0));
+
+  unsigned long const leaves = counts.plays[depth - 1];
+  printf("%lu leaves (%lu games over earlier) in %.3f s: %.0f leaves/s%s\n",
+         leaves, counts.finished, elapsed, leaves / elapsed,
+         (check ? " (including the cross-check)" : ""));
+
+  if (check) {
+    printf("Cross-checked %lu positions: %lu mismatches\n",
+           counts.checked, counts.mismatches);
+    if (counts.mismatches) { return 1; }
+  }
+
+  return 0;
+}
+
+/* EOF */
@@ -0,0 +1,140 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <plugin.h>
+#include <position.h>
+#include <search.h>
+#include <stats.h>
+#include <book.h>
+#include <budget.h>
+#include <timeman.h>
+#include <ttable.h>
+
+/*
+ * The decisions of 'my-player', shared by its process ('my-player.cc') and
+ * its plugin ('my-player.so', see 'plugin.h')
+ */
+
+namespace {
+
+search_config cfg;
+search_rng rng;
+bool seeded = false;
+
+position last_pos;   // position of the last move chosen
+multi_move last_move;
+
+} // end anon namespace
+
+
+unsigned int
+player_plugin_version()
+{
+  return PLAYER_PLUGIN_VERSION;
+}
+
+bool
+player_init()
+{
+  /* Pruning limits per game phase (may be tuned through the environment) */
+  if (!search_config_init(&cfg))
+    fprintf(stderr, "Ignoring malformed PLAYER_PRUNE.\n");
+
+  /* Time per move: from the MCP or PLAYER_TIME (none: no deep search) */
+  if (!time_init(&cfg.time))
+    fprintf(stderr, "Ignoring malformed PLAYER_TIME.\n");
+  if (cfg.time.limit > 0.0)
+    fprintf(stderr, "Time limit %.1f s per move.\n", cfg.time.limit);
+
+  /*
+   * Ties between equally good plays are broken by an explicitly seeded
+   * generator (PLAYER_SEED), otherwise the choice is fully deterministic
+   */
+  char const * const seed = getenv("PLAYER_SEED");
+  seeded = (seed != NULL);
+  if (seeded)
+    search_rng_seed(&rng, strtoull(seed, NULL, 0));
+
+  /* Per move statistics go to the file named by PLAYER_STATS (if any) */
+  if (!stats_init())
+    perror("Unable to open PLAYER_STATS");
+
+  /* Divide the address space the MCP grants us among the big consumers */
+  memory_budget budget;
+  if (!budget_init(&budget))
+    fprintf(stderr, "Ignoring malformed PLAYER_MEMORY.\n");
+
+  /*
+   * Transposition table: as large as the budget allows (smaller ones are
+   * tried if the memory is not available after all)
+   */
+  size_t const tt_bytes = tt_fit(budget.pool[POOL_TT]);
+
+  fprintf(stderr, "Memory budget:");
+  for (unsigned int pool = 0; pool < NUM_POOLS; ++pool)
+    fprintf(stderr, " %s %u%% (%zu MB)", budget_pool_name((budget_pool) pool),
+            budget.ratio[pool], budget.pool[pool] / BUDGET_MB);
+  fprintf(stderr, "\n");
+
+  if (budget.limit)
+    fprintf(stderr, "Memory limit %zu MB: ", budget.limit / BUDGET_MB);
+  fprintf(stderr, "transposition table %zu MB, book up to %zu MB.\n",
+          tt_bytes / BUDGET_MB, budget.pool[POOL_BOOK] / BUDGET_MB);
+
+  /* Opening book (optional): mapped once, looked up in microseconds */
+  char const * const book = getenv("PLAYER_BOOK");
+  if (!book_open(book ? book : "opening.book", budget.pool[POOL_BOOK]) && book)
+    fprintf(stderr, "Unable to open opening book '%s' (within %zu MB).\n",
+            book, budget.pool[POOL_BOOK] / BUDGET_MB);
+
+  return tt_bytes > 0;
+}
+
+void
+player_new_game()
+{
+  /* Nothing to forget: the tables stay valid across games */
+}
+
+bool
+player_choose_move(game_state const * const state, multi_move * const mmove)
+{
+  assert(state && mmove);
+
+  time_begin_move(&cfg.time);
+  position_init(&last_pos, state);
+
+  /*
+   * Select moves: known openings come from the book, otherwise generate
+   * every legal play, rank them statically and search only the most
+   * promising ones
+   */
+  search_stats stats;
+  stats_begin_move(&last_pos);
+
+  bool const from_book = book_lookup(&last_pos, mmove);
+  if (!from_book)
+    search_root(&last_pos, &cfg, (seeded ? &rng : NULL), mmove, &stats);
+  stats_end_move(from_book ? NULL : &stats);
+
+  last_move = *mmove;
+  return true;
+}
+
+void
+player_ponder(bool (* const interrupted)())
+{
+  assert(interrupted);
+
+  /* Fill the transposition table with our replies to his likely plays */
+  position pos = last_pos;
+
+  for (unsigned int mm = 0; mm < last_move.num_moves; ++mm)
+    position_move(&pos, &last_move.moves[mm]);
+  position_switch_player(&pos);
+
+  search_ponder(&pos, &cfg, interrupted);
+}
+
+/* EOF */
@@ -0,0 +1,271 @@
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+
+#include <position.h>
+
+namespace {
+
+/* No contact iff both rearmost checkers have passed each other */
+bool
+has_contact(position const * const pos)
+{
+  return pos->back[0] + pos->back[1] > DIST_BAR;
+}
+
+/* FNV-1a over the board, finished with a 64 bit mixer */
+unsigned long long
+hash_board(signed short int const * const board, signed char const player)
+{
+  unsigned long long h = 0xcbf29ce484222325ULL ^ (player & 0xff);
+
+  for (size_t cc = POS_BAR; cc <= POS_OFF; ++cc) {
+    h ^= (unsigned short int) board[cc];
+    h *= 0x100000001b3ULL;
+  }
+
+  h ^= h >> 33; h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33; h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+
+  return h;
+}
+
+/* Pips, rearmost checker and checkers borne off of one side */
+template <signed char player>
+void
+init_side(position * const pos)
+{
+  game_state const * const state = &pos->state;
+  unsigned int const s = side_of<player>();
+  unsigned int on_board = 0;
+
+  pos->pips[s] = 0;
+  pos->back[s] = 0;
+
+  for (unsigned int dist = 1; dist <= DIST_BAR; ++dist) {
+    unsigned int const num = checkers_at<player>(state, dist);
+
+    if (num == 0) { continue; }
+
+    on_board += num;
+    pos->pips[s] += num * dist;
+    pos->back[s] = dist;
+  }
+
+  assert(on_board <= NUM_CHECKERS);
+  pos->off[s] = NUM_CHECKERS - on_board;
+}
+
+template <signed char player>
+unsigned int
+keith_count(position const * const pos)
+{
+  game_state const * const state = &pos->state;
+  unsigned int const on_1 = checkers_at<player>(state, 1),
+                     on_2 = checkers_at<player>(state, 2),
+                     on_3 = checkers_at<player>(state, 3);
+  unsigned int count = pos->pips[side_of<player>()];
+
+  if (on_1 > 1) { count += 2 * (on_1 - 1); }
+  if (on_2 > 1) { count += on_2 - 1; }
+  if (on_3 > 3) { count += on_3 - 3; }
+
+  for (unsigned int dist = 4; dist <= HOME_POINTS; ++dist)
+    if (checkers_at<player>(state, dist) == 0) { ++count; }
+
+  return count;
+}
+
+template <signed char player>
+unsigned int
+thorp_count(position const * const pos)
+{
+  game_state const * const state = &pos->state;
+  unsigned int const s = side_of<player>();
+  unsigned int count = pos->pips[s]
+                     + 2 * (NUM_CHECKERS - pos->off[s])
+                     + checkers_at<player>(state, 1);
+
+  for (unsigned int dist = 1; dist <= HOME_POINTS; ++dist)
+    if (checkers_at<player>(state, dist) > 0) { --count; }
+
+  return count;
+}
+
+} // end anon namespace
+
+
+char const * const PHASE_NAMES[NUM_PHASES] = { "contact", "race", "bearoff" };
+
+
+void
+position_init(position * const pos, game_state const * const state)
+{
+  assert(pos && state);
+
+  pos->state = *state;
+  init_side<PLAYER_BELOW>(pos);
+  init_side<PLAYER_ABOVE>(pos);
+  pos->contact = has_contact(pos);
+}
+
+template <signed char player>
+void
+position_move(position * const pos, game_move const * const move)
+{
+  assert(pos && move);
+  assert(move->roll >= 1 && move->roll <= 6);
+
+  game_state * const state = &pos->state;
+  unsigned int const s = side_of<player>(), o = 1 - s;
+
+  assert(state->player == player);
+
+  unsigned int const from = (move->point_from == POS_BAR
+                             ? (unsigned int) DIST_BAR
+                             : distance_of<player>(move->point_from));
+  unsigned int const to = (from > move->roll ? from - move->roll : 0);
+
+  assert(checkers_at<player>(state, from) > 0 && "No checker to move");
+
+  /* Lift the checker */
+  if (from == DIST_BAR) {
+    if (player == PLAYER_BELOW)
+      set_lower_bar(&state->board[POS_BAR], bar_count<player>(state) - 1);
+    else
+      set_higher_bar(&state->board[POS_BAR], bar_count<player>(state) - 1);
+  } else {
+    state->board[move->point_from] -= player;
+  }
+
+  /* Drop it on the target point (hitting a blot) or bear it off */
+  if (to > 0) {
+    signed short int * const target = &state->board[point_of<player>(to)];
+
+    if (*target == -player) {
+      *target = 0;
+
+      if (player == PLAYER_BELOW)
+        set_higher_bar(&state->board[POS_BAR], bar_count<-player>(state) + 1);
+      else
+        set_lower_bar(&state->board[POS_BAR], bar_count<-player>(state) + 1);
+
+      /* The opponent's checker was 'DIST_BAR - to' away from home */
+      pos->pips[o] += to;
+      pos->back[o] = DIST_BAR;
+    }
+
+    *target += player;
+  } else {
+    state->board[POS_OFF] += player;
+    ++pos->off[s];
+  }
+
+  pos->pips[s] -= from - to;
+
+  /* Only a rearmost checker leaving its point moves the 'back' marker */
+  if (from == pos->back[s] && checkers_at<player>(state, from) == 0) {
+    unsigned int dist = from;
+
+    while (dist > 0 && checkers_at<player>(state, dist) == 0) { --dist; }
+    pos->back[s] = dist;
+  }
+
+  pos->contact = has_contact(pos);
+}
+
+template void position_move<PLAYER_BELOW>(position * const, game_move const * const);
+template void position_move<PLAYER_ABOVE>(position * const, game_move const * const);
+
+void
+position_move(position * const pos, game_move const * const move)
+{
+  assert(pos);
+
+  if (pos->state.player == PLAYER_BELOW)
+    position_move<PLAYER_BELOW>(pos, move);
+  else
+    position_move<PLAYER_ABOVE>(pos, move);
+}
+
+unsigned long long
+position_hash(position const * const pos)
+{
+  assert(pos);
+  return hash_board(pos->state.board, pos->state.player);
+}
+
+unsigned long long
+position_canonical_hash(position const * const pos)
+{
+  assert(pos);
+
+  game_state const * const state = &pos->state;
+
+  if (state->player == PLAYER_BELOW)
+    return hash_board(state->board, PLAYER_BELOW);
+
+  signed short int board[POINTS + 2];
+
+  board[POS_BAR] = 0;
+  set_lower_bar(&board[POS_BAR], get_higher_bar(state->board[POS_BAR]));
+  set_higher_bar(&board[POS_BAR], get_lower_bar(state->board[POS_BAR]));
+  board[POS_OFF] = -state->board[POS_OFF];
+
+  for (size_t cc = 1; cc <= POINTS; ++cc)
+    board[cc] = -state->board[mirror_point(cc)];
+
+  return hash_board(board, PLAYER_BELOW);
+}
+
+
+unsigned int
+race_keith_count(position const * const pos, signed char const player)
+{
+  assert(pos);
+  return (player == PLAYER_BELOW ? keith_count<PLAYER_BELOW>(pos)
+                                 : keith_count<PLAYER_ABOVE>(pos));
+}
+
+unsigned int
+race_thorp_count(position const * const pos, signed char const player)
+{
+  assert(pos);
+  return (player == PLAYER_BELOW ? thorp_count<PLAYER_BELOW>(pos)
+                                 : thorp_count<PLAYER_ABOVE>(pos));
+}
+
+double
+race_win_probability(position const * const pos)
+{
+  assert(pos);
+
+  signed char const player = pos->state.player;
+  unsigned int const s = side_of(player), o = 1 - s;
+
+  /* A side without checkers has already won */
+  if (pos->off[s] == NUM_CHECKERS) { return 1.0; }
+  if (pos->off[o] == NUM_CHECKERS) { return 0.0; }
+
+  /*
+   * Kleinman: the player on roll is worth about four pips; the spread of
+   * the remaining rolls grows with the square root of the total count.
+   */
+  double const own   = race_keith_count(pos, player),
+               other = race_keith_count(pos, -player),
+               sum   = own + other,
+               diff  = other - own + 4.0;
+
+  if (sum <= 4.0) { return (diff > 0.0 ? 1.0 : 0.0); }
+
+  return 0.5 * erfc(-diff / (2.0 * sqrt(sum - 4.0)));
+}
+
+double
+race_equity(position const * const pos)
+{
+  return 2.0 * race_win_probability(pos) - 1.0;
+}
+
+/* EOF */
@@ -0,0 +1,522 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <state.h>
+#include <state-internal.h>
+#include <rules.h>
+
+/*
+ * Verifies that the rules engine behaves exactly like the assembler version
+ * of 'state-internal.h': plays random games and compares both on every
+ * position reached (conversions, all single moves, all legal and many
+ * illegal multi moves, end of game) including the hints written to STDERR.
+ * 'rules_check_batch' has to agree with checking each candidate on its own.
+ * Afterwards the cost of 'apply_multi_move', of checking a batch and of
+ * converting a state is measured.
+ *
+ *   ./rules-check             10 games with a random seed
+ *   ./rules-check -n 100 -s 7 100 games, reproducibly
+ */
+
+namespace {
+
+/* Hints list a possible play, which need not be the same one */
+char const POSSIBILITY[] = "One possibility:";
+
+unsigned long failures = 0;
+
+/* Redirects STDERR into a string while alive */
+struct capture {
+  capture() : saved(stderr), buf(NULL), len(0)
+  {
+    stderr = open_memstream(&buf, &len);
+    assert(stderr);
+  }
+
+  ~capture()
+  {
+    if (stderr != saved) { stop(); }
+    free(buf);
+  }
+
+  std::string stop()
+  {
+    fclose(stderr);
+    stderr = saved;
+
+    std::string text(buf, len);
+    size_t const cut = text.find(POSSIBILITY);
+    if (cut != std::string::npos) { text.erase(cut + sizeof(POSSIBILITY) - 1); }
+    return text;
+  }
+
+  capture(capture const&) = delete;
+  capture& operator=(capture const&) = delete;
+
+  FILE * const saved;
+  char * buf;
+  size_t len;
+};
+
+bool
+same_state(game_state const * const a, game_state const * const b)
+{
+  return a->player == b->player &&
+         a->dice[0] == b->dice[0] && a->dice[1] == b->dice[1] &&
+         memcmp(a->board, b->board, sizeof(a->board)) == 0;
+}
+
+void
+print_mmove(multi_move const * const mmove)
+{
+  printf("%hhu |", mmove->num_moves);
+  for (size_t cc = 0; cc < mmove->num_moves && cc < MAX_MOVES; ++cc)
+    printf(" (%hu,%hu)", mmove->moves[cc].point_from, mmove->moves[cc].roll);
+  printf("\n");
+}
+
+void
+fail(char const * const what, game_state const * const state,
+     multi_move const * const mmove,
+     std::string const& asm_hint, std::string const& rules_hint)
+{
+  ++failures;
+  printf("MISMATCH in %s\n", what);
+  print_state(state);
+  if (mmove) { print_mmove(mmove); }
+  printf("asm:   %s", asm_hint.c_str());
+  printf("rules: %s", rules_hint.c_str());
+}
+
+/* All sequences of valid moves (including partial ones) in 'int_state' */
+void
+collect_plays(game_state const * const int_state,
+              unsigned short const * const dice, unsigned int const num_dice,
+              multi_move * const cur, std::vector<multi_move> * const plays)
+{
+  plays->push_back(*cur);
+  if (cur->num_moves == num_dice) { return; }
+
+  for (unsigned int d = 0; d < num_dice; ++d) {
+    if (dice[d] == 0 || (d && dice[d] == dice[d - 1])) { continue; }
+
+    unsigned short rest[MAX_MOVES];
+    for (unsigned int cc = 0; cc < num_dice; ++cc)
+      rest[cc] = (cc == d ? 0 : dice[cc]);
+
+    for (unsigned short from = POS_BAR; from <= POINTS; ++from) {
+      game_move const move = { from, dice[d] };
+      if (!rules_check_move(int_state, &move, false)) { continue; }
+
+      game_state next = *int_state;
+      rules_apply_move(&next, &move, false);
+
+      cur->moves[cur->num_moves++] = move;
+      collect_plays(&next, rest, num_dice, cur, plays);
+      cur->num_moves--;
+    }
+  }
+}
+
+/* Compare conversions and every single move in 'state' */
+void
+check_single_moves(game_state const * const state)
+{
+  game_state asm_int, rules_int, back;
+
+  to_internal(state, &asm_int);
+  rules_to_internal(state, &rules_int);
+  if (!same_state(&asm_int, &rules_int)) {
+    fail("to_internal", state, NULL, "", "");
+    return;
+  }
+
+  rules_to_internal(&rules_int, &back);
+  if (!same_state(&back, state)) { fail("from_internal", state, NULL, "", ""); }
+
+  for (unsigned short from = POS_BAR; from <= POS_OFF + 1; ++from) {
+    for (unsigned short roll = 1; roll <= 6; ++roll) {
+      game_move const move = { from, roll };
+      multi_move const single = { 1, { move, move, move, move } };
+      std::string asm_hint, rules_hint;
+
+      game_move asm_move, rules_move;
+      to_internal(&move, state->player, &asm_move);
+      rules_to_internal(&move, state->player, &rules_move);
+      if (memcmp(&asm_move, &rules_move, sizeof(asm_move)) != 0)
+        fail("to_internal (move)", state, &single, "", "");
+
+      rules_view const view = { state };
+      std::string view_hint;
+      bool asm_ok, rules_ok, view_ok;
+      { capture c; asm_ok = check_move(&asm_int, &move, true); asm_hint = c.stop(); }
+      { capture c; rules_ok = rules_check_move(&rules_int, &move, true); rules_hint = c.stop(); }
+      { capture c; view_ok = rules_check_move(&view, &move, true); view_hint = c.stop(); }
+
+      if (asm_ok != rules_ok || asm_hint != rules_hint) {
+        fail("check_move", &asm_int, &single, asm_hint, rules_hint);
+        continue;
+      }
+      if (view_ok != rules_ok || view_hint != rules_hint) {
+        fail("check_move (view)", &asm_int, &single, view_hint, rules_hint);
+        continue;
+      }
+      if (!asm_ok) { continue; }
+
+      game_state asm_next = asm_int, rules_next = rules_int;
+      { capture c; apply_move(&asm_next, &move, true); asm_hint = c.stop(); }
+      { capture c; rules_apply_move(&rules_next, &move, true); rules_hint = c.stop(); }
+
+      if (!same_state(&asm_next, &rules_next) || asm_hint != rules_hint)
+        fail("apply_move", &asm_int, &single, asm_hint, rules_hint);
+    }
+  }
+}
+
+/* Compare 'apply_multi_move' for a single play in 'state' */
+void
+check_multi_move(game_state const * const state, multi_move const * const mmove)
+{
+  game_state asm_state = *state, rules_state = *state;
+  std::string asm_hint, rules_hint;
+  bool asm_ok, rules_ok;
+
+  { capture c; asm_ok = apply_multi_move(&asm_state, mmove); asm_hint = c.stop(); }
+  { capture c; rules_ok = rules_apply_multi_move(&rules_state, mmove); rules_hint = c.stop(); }
+
+  if (asm_ok != rules_ok || asm_hint != rules_hint ||
+      !same_state(&asm_state, &rules_state))
+    fail("apply_multi_move", state, mmove, asm_hint, rules_hint);
+}
+
+/* Plays in general notation that are worth checking in 'state' */
+void
+candidate_plays(game_state const * const state, std::vector<multi_move> * const plays)
+{
+  game_state int_state;
+  rules_to_internal(state, &int_state);
+
+  unsigned short const d0 = state->dice[0], d1 = state->dice[1];
+  bool const is_double = (d0 == d1);
+  unsigned short const dice[MAX_MOVES] = {
+    std::min(d0, d1), std::max(d0, d1), d0, d1
+  };
+
+  multi_move cur;
+  cur.num_moves = 0;
+  collect_plays(&int_state, dice, (is_double ? MAX_MOVES : NUM_DICE), &cur, plays);
+
+  for (size_t cc = 0; cc < plays->size(); ++cc) {
+    rules_to_internal(&(*plays)[cc], state->player, &cur);
+    (*plays)[cc] = cur;
+  }
+}
+
+/* Random (mostly invalid) plays */
+multi_move
+random_play(game_state const * const state, multi_move const * const valid)
+{
+  multi_move mmove = *valid;
+
+  switch (rand() % 4) {
+  case 0: // change a single move
+    if (mmove.num_moves) {
+      game_move * const m = &mmove.moves[rand() % mmove.num_moves];
+      if (rand() % 2) { m->point_from = rand() % (POS_OFF + 2); }
+      else            { m->roll = 1 + rand() % 6; }
+    }
+    break;
+  case 1: // drop a move
+    if (mmove.num_moves) { mmove.num_moves--; }
+    break;
+  case 2: // add a move
+    if (mmove.num_moves < MAX_MOVES) {
+      game_move * const m = &mmove.moves[mmove.num_moves++];
+      m->point_from = rand() % (POS_OFF + 1);
+      m->roll = state->dice[rand() % NUM_DICE];
+    } else {
+      mmove.num_moves = MAX_MOVES + 1;
+    }
+    break;
+  default: // something completely different
+    mmove.num_moves = rand() % (MAX_MOVES + 1);
+    for (size_t cc = 0; cc < mmove.num_moves; ++cc) {
+      mmove.moves[cc].point_from = rand() % (POS_OFF + 1);
+      mmove.moves[cc].roll = (rand() % 4 ? state->dice[rand() % NUM_DICE]
+                                         : 1 + rand() % 6);
+    }
+    break;
+  }
+
+  return mmove;
+}
+
+double
+seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+struct sample {
+  game_state state;
+  multi_move mmove;
+};
+
+/* Average time (ns) 'apply' takes for one of the 'samples' */
+double
+measure(bool (*apply)(game_state*, multi_move const*),
+        std::vector<sample> const& samples)
+{
+  FILE * const saved = stderr;
+  if (samples.empty()) { return 0.0; }
+
+  stderr = fopen("/dev/null", "w");
+  assert(stderr);
+
+  unsigned long valid = 0;
+  double const start = seconds();
+  for (size_t cc = 0; cc < samples.size(); ++cc) {
+    game_state state = samples[cc].state;
+    valid += apply(&state, &samples[cc].mmove);
+  }
+  double const elapsed = seconds() - start;
+
+  fclose(stderr);
+  stderr = saved;
+
+  assert(valid <= samples.size());
+  return elapsed * 1e9 / samples.size();
+}
+
+/* Average time (ns) 'convert' takes for the state of one of the 'samples' */
+double
+measure(void (*convert)(game_state const*, game_state*),
+        std::vector<sample> const& samples)
+{
+  enum { ROUNDS = 100 };
+  game_state int_state;
+
+  if (samples.empty()) { return 0.0; }
+  unsigned long sum = 0;
+
+  double const start = seconds();
+  for (size_t round = 0; round < ROUNDS; ++round) {
+    for (size_t cc = 0; cc < samples.size(); ++cc) {
+      convert(&samples[cc].state, &int_state);
+      sum += int_state.board[1 + cc % POINTS];
+    }
+  }
+  double const elapsed = seconds() - start;
+
+  assert(sum < ~0ul);
+  return elapsed * 1e9 / (ROUNDS * samples.size());
+}
+
+/* All candidates checked in a position */
+struct batch {
+  game_state state;
+  std::vector<multi_move> mmoves;
+};
+
+/* Compare 'rules_check_batch' with checking each candidate on its own */
+void
+check_batch(batch const * const b)
+{
+  size_t const count = b->mmoves.size();
+  std::vector<game_state> results(count);
+  bool * const legal = new bool[count];
+
+  size_t const num_legal = rules_check_batch(&b->state, b->mmoves.data(), count,
+                                             legal, results.data());
+  size_t expected = 0;
+
+  for (size_t cc = 0; cc < count; ++cc) {
+    game_state state = b->state;
+    bool ok;
+    { capture c; ok = rules_apply_multi_move(&state, &b->mmoves[cc]); }
+
+    expected += ok;
+    if (ok != legal[cc] || !same_state(&state, &results[cc]))
+      fail("rules_check_batch", &b->state, &b->mmoves[cc], ok ? "valid\n" : "invalid\n",
+           legal[cc] ? "valid\n" : "invalid\n");
+  }
+
+  if (num_legal != expected)
+    fail("rules_check_batch (count)", &b->state, NULL, "", "");
+
+  delete[] legal;
+}
+
+/* Average time (ns) per candidate checked either in 'batches' or one by one */
+double
+measure(std::vector<batch> const& batches, bool const batched)
+{
+  FILE * const saved = stderr;
+  stderr = fopen("/dev/null", "w");
+  assert(stderr);
+
+  std::vector<game_state> results;
+  bool legal[1024];
+  size_t candidates = 0, valid = 0;
+
+  double const start = seconds();
+  for (size_t cc = 0; cc < batches.size(); ++cc) {
+    batch const& b = batches[cc];
+
+    for (size_t first = 0; first < b.mmoves.size(); first += 1024) {
+      size_t const count = std::min(b.mmoves.size() - first, (size_t) 1024);
+
+      if (batched) {
+        results.resize(count);
+        valid += rules_check_batch(&b.state, &b.mmoves[first], count, legal,
+                                   results.data());
+      } else {
+        for (size_t mm = first; mm < first + count; ++mm) {
+          game_state state = b.state;
+          valid += rules_apply_multi_move(&state, &b.mmoves[mm]);
+        }
+      }
+      candidates += count;
+    }
+  }
+  double const elapsed = seconds() - start;
+
+  fclose(stderr);
+  stderr = saved;
+
+  assert(valid <= candidates);
+  return (candidates ? elapsed * 1e9 / candidates : 0.0);
+}
+
+bool
+asm_apply(game_state * const state, multi_move const * const mmove)
+{
+  return apply_multi_move(state, mmove);
+}
+
+void
+asm_to_internal(game_state const * const state, game_state * const int_state)
+{
+  to_internal(state, int_state);
+}
+
+void
+rules_convert(game_state const * const state, game_state * const int_state)
+{
+  rules_to_internal(state, int_state);
+}
+
+void
+usage(char const * const prog)
+{
+  fprintf(stderr, "Usage: %s [-n games] [-s seed]\n"
+                  "  -n games - Random games to play (default: 10)\n"
+                  "  -s seed  - Seed of the games (default: random)\n",
+          prog);
+}
+
+} // end anon namespace
+
+
+int
+main(int argc, char * argv[])
+{
+  unsigned long games = 10;
+  unsigned int seed = time(NULL);
+  int opt;
+
+  while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+    switch (opt) {
+    case 'n': games = strtoul(optarg, NULL, 10); break;
+    case 's': seed  = strtoul(optarg, NULL, 10); break;
+    default:  usage(argv[0]); return EXIT_FAILURE;
+    }
+  }
+
+  if (optind != argc || games == 0) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  printf("rules-check: %lu games, seed %u\n", games, seed);
+  srand(seed);
+
+  std::vector<sample> samples;
+  std::vector<batch> batches;
+  unsigned long positions = 0, plays_checked = 0;
+
+  for (unsigned long game = 0; game < games; ++game) {
+    game_state state;
+    initialize_state(&state);
+    state.player = (rand() % 2 ? PLAYER_ABOVE : PLAYER_BELOW);
+
+    while (!rules_is_final_state(&state)) {
+      if (is_final_state(&state)) { fail("is_final_state", &state, NULL, "", ""); }
+
+      state.dice[0] = 1 + rand() % 6;
+      state.dice[1] = 1 + rand() % 6;
+      ++positions;
+
+      check_single_moves(&state);
+
+      std::vector<multi_move> plays;
+      candidate_plays(&state, &plays);
+
+      batch b = { state, std::vector<multi_move>() };
+      for (size_t cc = 0; cc < plays.size(); ++cc) {
+        b.mmoves.push_back(plays[cc]);
+        b.mmoves.push_back(random_play(&state, &plays[cc]));
+      }
+
+      for (size_t cc = 0; cc < b.mmoves.size(); ++cc)
+        check_multi_move(&state, &b.mmoves[cc]);
+      check_batch(&b);
+
+      plays_checked += b.mmoves.size();
+      batches.push_back(b);
+
+      /* Continue with a random valid play */
+      std::vector<multi_move> valid;
+      for (size_t cc = 0; cc < plays.size(); ++cc) {
+        game_state next = state;
+        capture c;
+        if (rules_apply_multi_move(&next, &plays[cc])) { valid.push_back(plays[cc]); }
+      }
+      assert(!valid.empty());
+
+      sample const s = { state, valid[rand() % valid.size()] };
+      samples.push_back(s);
+
+      { capture c; rules_apply_multi_move(&state, &s.mmove); }
+      state.player *= -1;
+    }
+
+    if (!is_final_state(&state) || winner(&state) != rules_winner(&state))
+      fail("winner", &state, NULL, "", "");
+  }
+
+  printf("%lu positions, %lu multi moves checked, %lu mismatches\n",
+         positions, plays_checked, failures);
+
+  printf("apply_multi_move: asm %.0f ns, rules %.0f ns per move\n",
+         measure(asm_apply, samples), measure(rules_apply_multi_move, samples));
+
+  printf("batch of moves:   single %.0f ns, rules_check_batch %.0f ns per move\n",
+         measure(batches, false), measure(batches, true));
+
+  printf("to_internal:      asm %.1f ns, rules %.1f ns per state\n",
+         measure(asm_to_internal, samples), measure(rules_convert, samples));
+
+  return (failures ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/* EOF */
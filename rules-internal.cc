@@ -0,0 +1,101 @@
+#include <rules.h>
+#include <state-internal.h>
+
+/*
+ * API of 'state-internal.h' on top of the rules engine. Linked instead of
+ * 'state-internal-*.s' (see RULES in the Makefile).
+ */
+
+void
+to_internal(unsigned char    const         pos,
+            signed short int const         val,
+            signed char      const         player,
+            unsigned char          * const int_pos,
+            signed short int       * const int_val)
+{
+  rules_to_internal(pos, val, player, int_pos, int_val);
+}
+
+void
+from_internal(unsigned char    const         int_pos,
+              signed short int const         int_val,
+              signed char      const         player,
+              unsigned char          * const pos,
+              signed short int       * const val)
+{
+  rules_to_internal(int_pos, int_val, player, pos, val);
+}
+
+void
+to_internal(game_state const * const state, game_state * const int_state)
+{
+  rules_to_internal(state, int_state);
+}
+
+void
+from_internal(game_state const * const int_state, game_state * const state)
+{
+  rules_to_internal(int_state, state);
+}
+
+void
+to_internal(game_move const * const move, signed char const player,
+            game_move * const int_move)
+{
+  rules_to_internal(move, player, int_move);
+}
+
+void
+from_internal(game_move const * const int_move, signed char const player,
+              game_move * const move)
+{
+  rules_to_internal(int_move, player, move);
+}
+
+void
+to_internal(multi_move const * const mmove, signed char const player,
+            multi_move * const int_mmove)
+{
+  rules_to_internal(mmove, player, int_mmove);
+}
+
+void
+from_internal(multi_move const * const int_mmove, signed char const player,
+              multi_move * const mmove)
+{
+  rules_to_internal(int_mmove, player, mmove);
+}
+
+bool
+is_final_state(game_state const * const state)
+{
+  return rules_is_final_state(state);
+}
+
+int
+winner(game_state const * const state)
+{
+  return rules_winner(state);
+}
+
+bool
+check_move(game_state const * const int_state,
+           game_move const * const int_move, bool output)
+{
+  return rules_check_move(int_state, int_move, output);
+}
+
+void
+apply_move(game_state * int_state, game_move const * const int_move,
+           bool output)
+{
+  rules_apply_move(int_state, int_move, output);
+}
+
+bool
+apply_multi_move(game_state * state, multi_move const * const mmove)
+{
+  return rules_apply_multi_move(state, mmove);
+}
+
+/* EOF */
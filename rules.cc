@@ -0,0 +1,750 @@
+#include <algorithm>
+
+#include <assert.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <rules.h>
+
+namespace {
+
+/* Everything the engine may tell a player about his moves */
+enum hint_id {
+  HINT_TOO_MANY_MOVES,
+  HINT_NO_DOUBLE,
+  HINT_DOUBLE,
+  HINT_RE_ENTER,
+  HINT_NO_CHECKER,
+  HINT_BAR_OPPONENT,
+  HINT_BAR_FIRST,
+  HINT_POINT_OPPONENT,
+  HINT_NO_DIE,
+  HINT_BLOCKED,
+  HINT_NOT_HOME,
+  HINT_INEXACT,
+  HINT_HIT,
+  HINT_BEAR_OFF,
+  HINT_USE_ALL_DICE,
+  HINT_USE_HIGHER_DIE,
+};
+
+char const * const HINTS[] = {
+  /* HINT_TOO_MANY_MOVES */ "You try to make too many moves.",
+  /* HINT_NO_DOUBLE      */ "You did not roll a double -- use each die only once!",
+  /* HINT_DOUBLE         */ "Doubles oblige you to use each die twice!",
+  /* HINT_RE_ENTER       */ "Checker must not re-enter the board once beared off",
+  /* HINT_NO_CHECKER     */ "There is no checker at point %hd",
+  /* HINT_BAR_OPPONENT   */ "Only own checkers may be moved (directly) and the bar is occupied by %hu checkers of your opponent",
+  /* HINT_BAR_FIRST      */ "Checkers from the bar have to re-enter first",
+  /* HINT_POINT_OPPONENT */ "Only own checkers may be moved (directly) and point %hu is occupied by %hu checkers of your opponent",
+  /* HINT_NO_DIE         */ "%hu does not match any die roll (%hu, %hu)",
+  /* HINT_BLOCKED        */ "Point %hu is occupied by %hu checkers of your opponent",
+  /* HINT_NOT_HOME       */ "You may not bear off unless *all* your checkers are in your home board. There is a checker on point %u",
+  /* HINT_INEXACT        */ "Die roll does not match exactly to bear off a checker from point %hu and there is a checker at point %hu",
+  /* HINT_HIT            */ "Opponent's blot at %hu is hit and goes to the bar",
+  /* HINT_BEAR_OFF       */ "Bearing off checker from %hu",
+  /* HINT_USE_ALL_DICE   */ "You must use all your dice if there are legal moves possible. One possibility: %s",
+  /* HINT_USE_HIGHER_DIE */ "When not using both dice you must use the higher one if possible. One possibility: %s",
+};
+
+enum {
+  HOME_START = POINTS - HOME_POINTS + 1, // first point of the internal home board
+  MAX_PLAY_LEN = 256,                    // length of a play printed in a hint
+};
+
+void
+hint(bool const output, hint_id const id, ...)
+{
+  if (!output) { return; }
+
+  va_list ap;
+  va_start(ap, id);
+  fputs("## hint: ", stderr);
+  vfprintf(stderr, HINTS[id], ap);
+  fputc('\n', stderr);
+  va_end(ap);
+}
+
+/*
+ * Internal point of a general one (and vice versa) for PLAYER_ABOVE (row 0)
+ * and PLAYER_BELOW (row 1). The bar and the off-board position never move.
+ */
+unsigned char const INTERNAL_POINT[2][POS_OFF + 1] = {
+  {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12,
+    13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25 },
+  {  0, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13,
+    12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1, 25 },
+};
+
+/* Internal point 'int_pos' of 'player' in general notation */
+unsigned int
+general_point(signed char const player, unsigned int const int_pos)
+{
+  return INTERNAL_POINT[player == PLAYER_BELOW][int_pos];
+}
+
+/*
+ * Boards the single move checks work on: a converted (internal) state or a
+ * view of a general one. Both present the internal board.
+ */
+struct internal_board {
+  game_state const * const state;
+
+  signed short int at(unsigned int const int_pos) const
+  { return state->board[int_pos]; }
+  unsigned short int own_bar() const
+  { return get_lower_bar(state->board[POS_BAR]); }
+  unsigned short int opp_bar() const
+  { return get_higher_bar(state->board[POS_BAR]); }
+};
+
+struct view_board {
+  rules_view const * const view;
+
+  signed short int at(unsigned int const int_pos) const
+  { return rules_view_at(view, int_pos); }
+  unsigned short int own_bar() const
+  { return rules_view_own_bar(view); }
+  unsigned short int opp_bar() const
+  { return rules_view_opp_bar(view); }
+};
+
+#ifdef __SSE2__
+/* Reverse the order of eight points */
+inline __m128i
+reverse_points(__m128i x)
+{
+  x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(0, 1, 2, 3));
+  x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(0, 1, 2, 3));
+  return _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2));
+}
+#endif
+
+/* Flip points 1 to 24 of the general board 'src' into the internal 'dst' */
+void
+flip_points(signed short int const * const src, signed short int * const dst,
+            signed char const player)
+{
+#ifdef __SSE2__
+  /* Three vectors of eight points: reversed for PLAYER_BELOW, negated else */
+  __m128i const a = _mm_loadu_si128((__m128i const*) (src + 1)),
+                b = _mm_loadu_si128((__m128i const*) (src + 9)),
+                c = _mm_loadu_si128((__m128i const*) (src + 17));
+
+  if (player == PLAYER_BELOW) {
+    _mm_storeu_si128((__m128i*) (dst +  1), reverse_points(c));
+    _mm_storeu_si128((__m128i*) (dst +  9), reverse_points(b));
+    _mm_storeu_si128((__m128i*) (dst + 17), reverse_points(a));
+  } else {
+    __m128i const zero = _mm_setzero_si128();
+    _mm_storeu_si128((__m128i*) (dst +  1), _mm_sub_epi16(zero, a));
+    _mm_storeu_si128((__m128i*) (dst +  9), _mm_sub_epi16(zero, b));
+    _mm_storeu_si128((__m128i*) (dst + 17), _mm_sub_epi16(zero, c));
+  }
+#else
+  for (unsigned int cc = 1; cc <= POINTS; ++cc)
+    dst[INTERNAL_POINT[player == PLAYER_BELOW][cc]] = src[cc] * player;
+#endif
+
+  for (unsigned int cc = 1; cc <= POINTS; ++cc)
+    assert(dst[cc] >= -NUM_CHECKERS && dst[cc] <= NUM_CHECKERS);
+}
+
+/* Checkers of PLAYER_ABOVE (0) and PLAYER_BELOW (1) on the board or bar */
+void
+count_checkers(game_state const * const state, int count[2])
+{
+  assert(state);
+
+  count[0] = count[1] = 0;
+
+  for (size_t cc = 1; cc <= POINTS; ++cc) {
+    signed short int const v = state->board[cc];
+    count[v > 0] += abs(v);
+  }
+
+  count[0] += get_higher_bar(state->board[POS_BAR]);
+  count[1] += get_lower_bar(state->board[POS_BAR]);
+
+  assert(count[0] >= 0 && count[0] <= NUM_CHECKERS && count[1] >= 0 && count[1] <= NUM_CHECKERS);
+}
+
+/* Do the dice used by 'mmove' fit the roll in 'state'? */
+bool
+check_rolls(game_state const * const state, multi_move const * const mmove,
+            bool const output)
+{
+  game_move const * const m = mmove->moves;
+
+  if (mmove->num_moves > MAX_MOVES) {
+    hint(output, HINT_TOO_MANY_MOVES);
+    return false;
+  }
+
+  /* Each die once */
+  if (state->dice[0] != state->dice[1]) {
+    if (mmove->num_moves > NUM_DICE ||
+        (mmove->num_moves == NUM_DICE && m[0].roll == m[1].roll)) {
+      hint(output, HINT_NO_DOUBLE);
+      return false;
+    }
+    return true;
+  }
+
+  /* Doubles: all moves use the same die */
+  for (size_t cc = 1; cc < mmove->num_moves && mmove->num_moves > 2; ++cc) {
+    if (m[cc].roll != m[0].roll) {
+      hint(output, HINT_DOUBLE);
+      return false;
+    }
+  }
+  return true;
+}
+
+/* May a checker leave 'from' (internal board)? */
+template <typename board_type>
+bool
+check_from(board_type const& b, signed char const player,
+           unsigned short const from, bool const output)
+{
+  if (from > POINTS) {
+    hint(output, HINT_RE_ENTER);
+    return false;
+  }
+
+  signed short int const val = b.at(from);
+
+  if (val == 0) {
+    hint(output, HINT_NO_CHECKER, general_point(player, from));
+    return false;
+  }
+
+  unsigned short int const own_bar = b.own_bar(),
+                           opp_bar = b.opp_bar();
+
+  if (from == POS_BAR && own_bar == 0) {
+    hint(output, HINT_BAR_OPPONENT, opp_bar);
+    return false;
+  }
+
+  if (from != POS_BAR && own_bar != 0) {
+    hint(output, HINT_BAR_FIRST);
+    return false;
+  }
+
+  if (val < 0) {
+    hint(output, HINT_POINT_OPPONENT, general_point(player, from), abs(val));
+    return false;
+  }
+
+  return true;
+}
+
+/* Single move check on either kind of board (see 'rules_check_move') */
+template <typename board_type>
+bool
+check_move(board_type const& b, game_state const * const state,
+           game_move const * const int_move, bool const output)
+{
+  signed char const player = state->player;
+  unsigned short const from = int_move->point_from,
+                       roll = int_move->roll;
+
+  if (roll != state->dice[0] && roll != state->dice[1]) {
+    hint(output, HINT_NO_DIE, roll, state->dice[0], state->dice[1]);
+    return false;
+  }
+
+  if (!check_from(b, player, from, output)) { return false; }
+
+  unsigned short const to = from + roll;
+  assert(to > POS_BAR);
+
+  /* Moving on the board */
+  if (to <= POINTS) {
+    signed short int const val = b.at(to);
+
+    if (val < -1) {
+      hint(output, HINT_BLOCKED, general_point(player, to), abs(val));
+      return false;
+    }
+    return true;
+  }
+
+  /* Bearing off: all checkers have to be in the home board... */
+  for (unsigned int cc = 1; cc < HOME_START; ++cc) {
+    if (b.at(cc) > 0) {
+      hint(output, HINT_NOT_HOME, general_point(player, cc));
+      return false;
+    }
+  }
+
+  /* ...and higher rolls only bear off the rearmost checker */
+  if (to > POS_OFF) {
+    for (unsigned short cc = HOME_START; cc < from; ++cc) {
+      if (check_from(b, player, cc, false)) {
+        hint(output, HINT_INEXACT, general_point(player, from),
+             general_point(player, cc));
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+/* Print the plays in 'int_mmove' for a hint */
+void
+format_play(game_state const * const int_state,
+            multi_move const * const int_mmove, char * const buf)
+{
+  int bytes = 0;
+
+  buf[0] = '\0';
+  for (size_t cc = 0; cc < int_mmove->num_moves; ++cc) {
+    game_move move;
+
+    rules_to_internal(&int_mmove->moves[cc], int_state->player, &move);
+    bytes += snprintf(buf + bytes, MAX_PLAY_LEN - bytes, "(%hu %hu) ",
+                      move.point_from, move.roll);
+  }
+}
+
+/*
+ * Depth-first search for the longest sequence of moves in 'int_state' using
+ * the dice in 'dice' (up to 'num_dice' of them, each one once). The search
+ * stops as soon as all dice are used. Returns the length of the longest
+ * sequence and stores it in 'best'.
+ */
+unsigned int
+longest_sequence(game_state const * const int_state,
+                 unsigned short const * const dice, unsigned int const num_dice,
+                 multi_move * const cur, multi_move * const best)
+{
+  if (cur->num_moves > best->num_moves) { *best = *cur; }
+  if (cur->num_moves == num_dice) { return num_dice; }
+
+  /* Checkers on the bar have to move first */
+  unsigned short const last =
+    (get_lower_bar(int_state->board[POS_BAR]) ? POS_BAR : POINTS);
+
+  for (unsigned int d = 0; d < num_dice; ++d) {
+    /* Try each die value only once on this level */
+    bool seen = (dice[d] == 0);
+    for (unsigned int cc = 0; cc < d && !seen; ++cc)
+      seen = (dice[cc] == dice[d]);
+    if (seen) { continue; }
+
+    unsigned short rest[MAX_MOVES];
+    for (unsigned int cc = 0; cc < num_dice; ++cc)
+      rest[cc] = (cc == d ? 0 : dice[cc]);
+
+    for (unsigned short from = POS_BAR; from <= last; ++from) {
+      if (int_state->board[from] <= 0) { continue; }
+
+      game_move const move = { from, dice[d] };
+      if (!rules_check_move(int_state, &move, false)) { continue; }
+
+      game_state next = *int_state;
+      rules_apply_move(&next, &move, false);
+
+      cur->moves[cur->num_moves++] = move;
+      unsigned int const len = longest_sequence(&next, rest, num_dice, cur, best);
+      cur->num_moves--;
+
+      if (len == num_dice) { return len; }
+    }
+  }
+
+  return best->num_moves;
+}
+
+/* Per batch precomputation for 'rules_check_batch' */
+struct batch_context {
+  game_state int_state;
+  unsigned int blocked;     // bit set for each point held by the opponent
+  unsigned int outside;     // own checkers on the bar or outside the home
+  unsigned short high;      // higher die
+  unsigned int max_dice;    // dice used by a full move
+  int max_moves;            // dice that can be used at most (-1: unknown)
+  bool high_playable;       // may a single move use the higher die?
+};
+
+void
+init_batch(batch_context * const ctx, game_state const * const state)
+{
+  rules_to_internal(state, &ctx->int_state);
+
+  signed short int const * const b = ctx->int_state.board;
+
+  ctx->blocked = 0;
+  ctx->outside = get_lower_bar(b[POS_BAR]);
+  for (unsigned int cc = 1; cc <= POINTS; ++cc) {
+    if (b[cc] < -1) { ctx->blocked |= 1u << cc; }
+    if (b[cc] > 0 && cc < HOME_START) { ctx->outside += b[cc]; }
+  }
+
+  ctx->high = std::max(state->dice[0], state->dice[1]);
+  ctx->max_dice = (state->dice[0] == state->dice[1] ? MAX_MOVES : NUM_DICE);
+  ctx->max_moves = -1;
+  ctx->high_playable = false;
+}
+
+/* Knowledge that is only needed for candidates not using all dice */
+void
+complete_batch(batch_context * const ctx)
+{
+  if (ctx->max_moves >= 0) { return; }
+
+  ctx->max_moves = rules_max_moves(&ctx->int_state, NULL);
+
+  for (unsigned short from = POS_BAR; from <= POINTS && !ctx->high_playable; ++from) {
+    game_move const move = { from, ctx->high };
+    ctx->high_playable = (ctx->int_state.board[from] > 0 &&
+                          rules_check_move(&ctx->int_state, &move, false));
+  }
+}
+
+/* Same as 'rules_check_move' without hints, using the batch's knowledge */
+bool
+batch_check_move(batch_context const * const ctx,
+                 game_state const * const int_state, unsigned int const outside,
+                 game_move const * const move)
+{
+  signed short int const * const b = int_state->board;
+  unsigned short const from = move->point_from,
+                       roll = move->roll,
+                       to   = from + roll;
+
+  if (roll != int_state->dice[0] && roll != int_state->dice[1]) { return false; }
+  if (from > POINTS) { return false; }
+
+  unsigned short int const own_bar = get_lower_bar(b[POS_BAR]);
+  if (from == POS_BAR ? own_bar == 0 : (own_bar != 0 || b[from] <= 0)) { return false; }
+
+  if (to <= POINTS) { return !(ctx->blocked & (1u << to)); }
+  if (outside) { return false; }
+
+  for (unsigned short cc = HOME_START; cc < from && to > POS_OFF; ++cc)
+    if (b[cc] > 0) { return false; }
+
+  return true;
+}
+
+/* Validate and apply a single candidate of a batch */
+bool
+batch_apply(batch_context * const ctx, multi_move const * const mmove,
+            game_state * const result)
+{
+  if (!check_rolls(&ctx->int_state, mmove, false)) { return false; }
+
+  game_state int_state = ctx->int_state;
+  unsigned int outside = ctx->outside;
+
+  for (size_t cc = 0; cc < mmove->num_moves; ++cc) {
+    game_move int_move;
+    rules_to_internal(&mmove->moves[cc], int_state.player, &int_move);
+
+    if (!batch_check_move(ctx, &int_state, outside, &int_move)) { return false; }
+    if (int_move.point_from < HOME_START &&
+        int_move.point_from + int_move.roll >= HOME_START) { --outside; }
+
+    rules_apply_move(&int_state, &int_move, false);
+  }
+
+  unsigned int const num_moves = mmove->num_moves;
+  if (num_moves != ctx->max_dice) {
+    complete_batch(ctx);
+
+    if ((unsigned int) ctx->max_moves > num_moves) { return false; }
+    if (ctx->max_dice == NUM_DICE && num_moves == 1 &&
+        mmove->moves[0].roll != ctx->high && ctx->high_playable) { return false; }
+  }
+
+  rules_to_internal(&int_state, result);
+  return true;
+}
+
+} // end anon namespace
+
+
+void
+rules_to_internal(unsigned char    const         pos,
+                  signed short int const         val,
+                  signed char      const         player,
+                  unsigned char          * const int_pos,
+                  signed short int       * const int_val)
+{
+  assert(int_pos && int_val);
+  assert(pos <= POS_OFF);
+  assert(pos == POS_BAR || (val >= -NUM_CHECKERS && val <= NUM_CHECKERS));
+  assert(player == PLAYER_ABOVE || player == PLAYER_BELOW);
+
+  *int_pos = INTERNAL_POINT[player == PLAYER_BELOW][pos];
+
+  if (pos != POS_BAR) {
+    *int_val = val * player;
+  } else if (player == PLAYER_BELOW) {
+    *int_val = val;
+  } else {
+    /* Swap both sides of the bar: the active player is always "lower" */
+    signed short int const lower_val = get_lower_bar(val),
+                           higher_val = get_higher_bar(val);
+
+    assert(lower_val <= NUM_CHECKERS && higher_val <= NUM_CHECKERS);
+    *int_val = 0;
+    set_lower_bar(int_val, higher_val);
+    set_higher_bar(int_val, lower_val);
+  }
+}
+
+void
+rules_to_internal(game_state const * const state,
+                  game_state       * const int_state)
+{
+  assert(state && int_state);
+  assert(state != int_state);
+
+  int_state->player  = state->player;
+  int_state->dice[0] = state->dice[0];
+  int_state->dice[1] = state->dice[1];
+
+  flip_points(state->board, int_state->board, state->player);
+
+  unsigned char int_pos;
+  rules_to_internal(POS_BAR, state->board[POS_BAR], state->player,
+                    &int_pos, &int_state->board[POS_BAR]);
+  rules_to_internal(POS_OFF, state->board[POS_OFF], state->player,
+                    &int_pos, &int_state->board[POS_OFF]);
+}
+
+void
+rules_to_internal(game_move const * const move,
+                  signed char       const player,
+                  game_move       * const int_move)
+{
+  assert(move && int_move);
+  assert(move != int_move);
+  assert(player == PLAYER_ABOVE || player == PLAYER_BELOW);
+
+  unsigned short const from = move->point_from;
+
+  /* Like the assembler version, points beyond POS_OFF wrap around */
+  int_move->point_from =
+    (from == POS_BAR || from == POS_OFF || player == PLAYER_ABOVE
+     ? from : (unsigned short) (POS_OFF - from));
+  int_move->roll = move->roll;
+}
+
+void
+rules_to_internal(multi_move const * const mmove,
+                  signed char        const player,
+                  multi_move       * const int_mmove)
+{
+  assert(mmove && int_mmove);
+  assert(mmove != int_mmove);
+
+  int_mmove->num_moves = mmove->num_moves;
+
+  for (size_t cc = 0; cc < mmove->num_moves; ++cc)
+    rules_to_internal(&mmove->moves[cc], player, &int_mmove->moves[cc]);
+}
+
+bool
+rules_is_final_state(game_state const * const state)
+{
+  assert(state);
+
+  int count[2];
+  count_checkers(state, count);
+
+  return (count[0] == 0 || count[1] == 0);
+}
+
+int
+rules_winner(game_state const * const state)
+{
+  assert(state);
+
+  int count[2];
+  count_checkers(state, count);
+
+  assert((count[0] == 0 && count[1] > 0) || (count[1] == 0 && count[0] > 0));
+
+  int const winner = (count[0] == 0 ? PLAYER_ABOVE : PLAYER_BELOW);
+  assert(winner != state->player);
+
+  /* A loser who has not borne off any checker loses a gammon... */
+  int const loser_count = count[winner == PLAYER_ABOVE ? 1 : 0];
+  if (loser_count < NUM_CHECKERS) { return winner; }
+
+  /* ...or even a backgammon with checkers in the winner's home or on the bar */
+  unsigned int const home = (winner == PLAYER_ABOVE ? HOME_START : 1);
+  int in_home = 0;
+
+  for (unsigned int cc = home; cc < home + HOME_POINTS; ++cc)
+    in_home += abs(state->board[cc]);
+
+  return winner * (in_home || state->board[POS_BAR] ? 3 : 2);
+}
+
+bool
+rules_check_move(game_state const * const int_state,
+                 game_move  const * const int_move, bool const output)
+{
+  assert(int_state && int_move);
+
+  internal_board const board = { int_state };
+  return check_move(board, int_state, int_move, output);
+}
+
+bool
+rules_check_move(rules_view const * const view,
+                 game_move  const * const int_move, bool const output)
+{
+  assert(view && view->state && int_move);
+
+  view_board const board = { view };
+  return check_move(board, view->state, int_move, output);
+}
+
+void
+rules_apply_move(game_state * const int_state,
+                 game_move const * const int_move, bool const output)
+{
+  assert(int_state && int_move);
+
+  signed short int * const b = int_state->board;
+  unsigned short const from = int_move->point_from,
+                       to   = from + int_move->roll;
+
+  assert(from < POS_OFF && "Re-entering is not allowed");
+  assert(b[from] > 0 && "No own checker to move");
+  assert(to > POS_BAR && to <= POS_OFF + 5);
+  assert((to >= POS_OFF || b[to] >= -1) && "Destination held by opponent");
+
+  if (from == POS_BAR)
+    set_lower_bar(&b[POS_BAR], get_lower_bar(b[POS_BAR]) - 1);
+  else
+    --b[from];
+
+  if (to > POINTS) {
+    hint(output, HINT_BEAR_OFF, general_point(int_state->player, from));
+    ++b[POS_OFF];
+  } else if (b[to] == -1) {
+    hint(output, HINT_HIT, general_point(int_state->player, to));
+    set_higher_bar(&b[POS_BAR], get_higher_bar(b[POS_BAR]) + 1);
+    b[to] = 1;
+  } else {
+    ++b[to];
+  }
+}
+
+unsigned int
+rules_max_moves(game_state const * const int_state, multi_move * const mmove)
+{
+  assert(int_state);
+
+  unsigned short const * const d = int_state->dice;
+  bool const is_double = (d[0] == d[1]);
+  unsigned short const dice[MAX_MOVES] = { d[0], d[1], d[0], d[1] };
+
+  multi_move cur, best;
+  cur.num_moves = best.num_moves = 0;
+
+  unsigned int const len = longest_sequence(int_state, dice,
+                                            (is_double ? MAX_MOVES : NUM_DICE),
+                                            &cur, &best);
+  if (mmove) { *mmove = best; }
+  return len;
+}
+
+bool
+rules_apply_multi_move(game_state * const state,
+                       multi_move const * const mmove)
+{
+  assert(state && mmove);
+  assert(state->player == PLAYER_ABOVE || state->player == PLAYER_BELOW);
+  assert(state->dice[0] > 0 && state->dice[1] > 0 && state->dice[0] < 7 && state->dice[1] < 7 && "Broken dice");
+
+  if (!check_rolls(state, mmove, true)) { return false; }
+
+  game_state int_state;
+  multi_move int_mmove;
+
+  rules_to_internal(state, &int_state);
+  rules_to_internal(mmove, state->player, &int_mmove);
+
+  game_state const start = int_state;
+
+  /* Each single move has to be valid... */
+  for (size_t cc = 0; cc < int_mmove.num_moves; ++cc) {
+    if (!rules_check_move(&int_state, &int_mmove.moves[cc], true)) { return false; }
+    rules_apply_move(&int_state, &int_mmove.moves[cc], true);
+  }
+
+  bool const is_double = (state->dice[0] == state->dice[1]);
+  unsigned int const num_moves = mmove->num_moves;
+
+  /* ...and as many dice as possible have to be used */
+  if (num_moves != (is_double ? MAX_MOVES : NUM_DICE)) {
+    char buf[MAX_PLAY_LEN];
+    multi_move longer;
+
+    if (rules_max_moves(&start, &longer) > num_moves) {
+      format_play(&start, &longer, buf);
+      hint(true, HINT_USE_ALL_DICE, buf);
+      return false;
+    }
+
+    /* If only one die can be used, it has to be the higher one */
+    unsigned short const high = std::max(state->dice[0], state->dice[1]);
+
+    if (!is_double && num_moves == 1 && mmove->moves[0].roll != high) {
+      for (unsigned short from = POS_BAR; from <= POINTS; ++from) {
+        game_move const move = { from, high };
+
+        if (start.board[from] > 0 && rules_check_move(&start, &move, false)) {
+          multi_move alternative;
+          alternative.num_moves = 1;
+          alternative.moves[0] = move;
+
+          format_play(&start, &alternative, buf);
+          hint(true, HINT_USE_HIGHER_DIE, buf);
+          return false;
+        }
+      }
+    }
+  }
+
+  rules_to_internal(&int_state, state);
+  return true;
+}
+
+size_t
+rules_check_batch(game_state const * const state,
+                  multi_move const * const mmoves, size_t const count,
+                  bool * const legal, game_state * const results)
+{
+  assert(state && (mmoves || !count) && legal && results);
+  assert(state->player == PLAYER_ABOVE || state->player == PLAYER_BELOW);
+  assert(state->dice[0] > 0 && state->dice[1] > 0 && state->dice[0] < 7 && state->dice[1] < 7 && "Broken dice");
+
+  batch_context ctx;
+  init_batch(&ctx, state);
+
+  size_t num_legal = 0;
+  for (size_t cc = 0; cc < count; ++cc) {
+    legal[cc] = batch_apply(&ctx, &mmoves[cc], &results[cc]);
+    if (legal[cc]) { ++num_legal; }
+    else           { results[cc] = *state; }
+  }
+
+  return num_legal;
+}
+
+/* EOF */
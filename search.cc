@@ -0,0 +1,436 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#include <dice.h>
+#include <eval.h>
+#include <movegen.h>
+#include <search.h>
+#include <stats.h>
+#include <timeman.h>
+#include <ttable.h>
+
+namespace {
+
+enum {
+  REPLY_DEPTH = 1, // transposition table depth of 'expected_reply' results
+  DEEP_DEPTH  = 2, // ... and of 'deep_reply' results
+};
+
+prune_limits const DEFAULT_PRUNE[NUM_PHASES] = {
+  { 8, 0.20 }, // contact: most plays differ, look at several
+  { 4, 0.10 }, // race: the static race formulas are already good
+  { 3, 0.05 }, // bear-off: few plays are close
+};
+
+struct candidate {
+  play const * p;
+  double score;
+};
+
+/*
+ * Outcomes of all our 'plays' for us, judged by the static evaluation only
+ * (of all resulting positions at once)
+ */
+void
+static_outcomes(play_vector const & plays, std::vector<outcome> * const results)
+{
+  std::vector<position> next(plays.size());
+
+  for (size_t cc = 0; cc < plays.size(); ++cc) {
+    next[cc] = plays[cc].result;
+    position_switch_player(&next[cc]);
+  }
+
+  results->resize(plays.size());
+  evaluate_batch(next.data(), next.size(), results->data());
+
+  for (outcome & o : *results) { o = outcome_flip(o); }
+}
+
+/* The play in 'plays' with the best static equity (the first of equals) */
+play const *
+best_static_play(play_vector const & plays, outcome * const best)
+{
+  std::vector<outcome> outcomes;
+  play const * pick = NULL;
+  double pick_equity = 0.0;
+
+  static_outcomes(plays, &outcomes);
+
+  for (size_t cc = 0; cc < plays.size(); ++cc) {
+    double const equity = outcome_equity(outcomes[cc]);
+
+    if (!pick || equity > pick_equity) {
+      pick = &plays[cc]; pick_equity = equity; *best = outcomes[cc];
+    }
+  }
+  return pick;
+}
+
+/*
+ * Outcomes of 'pos' for the player on roll, averaged over all his rolls, if
+ * he always picks the play with the best static equity. Adds the number of
+ * plays evaluated to 'stats' (also when the result is known already); 'ply'
+ * is the depth of 'pos' below the root.
+ */
+outcome
+expected_reply(position const * const pos, unsigned int const ply,
+               search_stats * const stats)
+{
+  unsigned long long const key = position_hash(pos);
+  unsigned int nodes = 0;
+  outcome value;
+
+  bool const hit = tt_probe(key, REPLY_DEPTH, &value, &nodes);
+  stats_count_probe(hit);
+
+  if (hit) {
+    stats->nodes += nodes;
+    stats->tt_hits++;
+    return value;
+  }
+
+  position rolled = *pos;
+  play_vector plays;
+
+  value = outcome();
+
+  for (roll_info const * roll = roll_begin(); roll != roll_end(); ++roll) {
+    outcome best;
+
+    rolled.state.dice[0] = roll->dice[0];
+    rolled.state.dice[1] = roll->dice[1];
+
+    double const gen_start = stats_clock();
+    generate_plays(&rolled, &plays);
+    stats_add_time(STATS_GENERATE, gen_start);
+    stats_count_generated(ply, plays.size());
+
+    double const eval_start = stats_clock();
+    best_static_play(plays, &best);
+    stats_add_time(STATS_EVALUATE, eval_start);
+    stats_count_evaluations(plays.size());
+
+    outcome_add(&value, best, roll_probability(*roll));
+    nodes += plays.size();
+  }
+
+  tt_store(key, REPLY_DEPTH, value, nodes);
+  stats->nodes += nodes;
+  return value;
+}
+
+/*
+ * Like 'expected_reply', but one ply deeper: for each of his rolls the
+ * player on roll in 'pos' picks his best static play, after which his
+ * opponent's outcomes come from 'expected_reply'. Returns false without a
+ * result, if the time was up before all rolls were searched.
+ */
+bool
+deep_reply(position const * const pos, time_budget const * const time,
+           search_stats * const stats, outcome * const value)
+{
+  unsigned long long const key = position_hash(pos);
+  unsigned int nodes = 0;
+
+  bool const hit = tt_probe(key, DEEP_DEPTH, value, &nodes);
+  stats_count_probe(hit);
+
+  if (hit) {
+    stats->nodes += nodes;
+    stats->tt_hits++;
+    return true;
+  }
+
+  position rolled = *pos;
+  play_vector plays;
+  unsigned long const nodes_before = stats->nodes;
+
+  *value = outcome();
+
+  for (roll_info const * roll = roll_begin(); roll != roll_end(); ++roll) {
+    if (time_up(time)) { return false; }
+
+    outcome best;
+
+    rolled.state.dice[0] = roll->dice[0];
+    rolled.state.dice[1] = roll->dice[1];
+
+    double const gen_start = stats_clock();
+    generate_plays(&rolled, &plays);
+    stats_add_time(STATS_GENERATE, gen_start);
+    stats_count_generated(1, plays.size());
+
+    double const eval_start = stats_clock();
+    play const * const pick = best_static_play(plays, &best);
+    stats_add_time(STATS_EVALUATE, eval_start);
+    stats_count_evaluations(plays.size());
+
+    /* A play that ends the game needs no answer */
+    position answer = pick->result;
+    if (answer.off[side_of(answer.state.player)] != NUM_CHECKERS) {
+      position_switch_player(&answer);
+      best = outcome_flip(expected_reply(&answer, 2, stats));
+    }
+
+    outcome_add(value, best, roll_probability(*roll));
+    stats->nodes += plays.size();
+  }
+
+  nodes = stats->nodes - nodes_before;
+  tt_store(key, DEEP_DEPTH, *value, nodes);
+  return true;
+}
+
+} // end anon namespace
+
+
+bool
+search_config_init(search_config * const cfg)
+{
+  assert(cfg);
+
+  memcpy(cfg->prune, DEFAULT_PRUNE, sizeof(cfg->prune));
+  cfg->time.limit = 0.0;
+  cfg->time.start = 0.0;
+
+  char const * env = getenv("PLAYER_PRUNE");
+  if (!env) { return true; }
+
+  /* Comma separated list of 'phase=top_k/margin' */
+  while (*env) {
+    char name[16];
+    unsigned int top_k;
+    double margin;
+    int len = 0;
+
+    if (sscanf(env, "%15[a-z]=%u/%lf%n", name, &top_k, &margin, &len) != 3)
+      return false;
+
+    size_t phase;
+    for (phase = 0; phase < NUM_PHASES; ++phase)
+      if (!strcmp(name, PHASE_NAMES[phase])) { break; }
+
+    if (phase == NUM_PHASES || top_k == 0 || margin < 0.0) { return false; }
+
+    cfg->prune[phase].top_k  = top_k;
+    cfg->prune[phase].margin = margin;
+
+    env += len;
+    if (*env == ',') { ++env; }
+  }
+
+  return true;
+}
+
+void
+search_rng_seed(search_rng * const rng, unsigned long long const seed)
+{
+  assert(rng);
+  rng->state = seed;
+}
+
+unsigned long long
+search_rng_next(search_rng * const rng)
+{
+  assert(rng);
+
+  /* splitmix64 (http://prng.di.unimi.it/splitmix64.c) */
+  unsigned long long z = (rng->state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+void
+search_root(position const * const pos, search_config const * const cfg,
+            search_rng * const rng, multi_move * const mmove,
+            search_stats * const stats)
+{
+  assert(pos && cfg && mmove);
+
+  search_stats local;
+  search_stats * const st = (stats ? stats : &local);
+  memset(st, 0, sizeof(*st));
+
+  double const start = stats_clock();
+  play_vector plays;
+  generate_plays(pos, &plays);
+  stats_add_time(STATS_GENERATE, start);
+  stats_count_generated(0, plays.size());
+
+  assert(!plays.empty() && "Generator returns at least the empty play");
+
+  st->plays = plays.size();
+  st->nodes = plays.size();
+
+  /* Forced play: nothing to decide */
+  if (plays.size() == 1) {
+    *mmove = plays[0].mmove;
+    stats_add_time(STATS_SEARCH, start);
+    return;
+  }
+
+  /* Stage 1: rank all plays with the cheap static evaluation */
+  std::vector<candidate> cands(plays.size());
+  std::vector<outcome> outcomes;
+
+  double const eval_start = stats_clock();
+  static_outcomes(plays, &outcomes);
+  for (size_t cc = 0; cc < plays.size(); ++cc) {
+    cands[cc].p     = &plays[cc];
+    cands[cc].score = outcome_equity(outcomes[cc]);
+  }
+  stats_add_time(STATS_EVALUATE, eval_start);
+  stats_count_evaluations(plays.size());
+
+  std::stable_sort(cands.begin(), cands.end(),
+                   [](candidate const & a, candidate const & b) {
+                     return a.score > b.score;
+                   });
+
+  /* Stage 2: keep the top-k plays close enough to the best one */
+  prune_limits const * const limits = &cfg->prune[position_phase(pos)];
+  size_t keep = 1;
+
+  while (keep < cands.size() && keep < limits->top_k &&
+         cands[keep].score >= cands[0].score - limits->margin)
+    ++keep;
+
+  cands.resize(keep);
+
+  /* Stage 3: search the survivors one ply deeper, judged by the equity of
+     the outcomes expected after the opponent's reply */
+  if (keep > 1) {
+    for (candidate & c : cands) {
+      position next = c.p->result;
+
+      /* A play that ends the game needs no answer, its static outcome is exact */
+      if (next.off[side_of(next.state.player)] == NUM_CHECKERS) { continue; }
+
+      position_switch_player(&next);
+      c.score = outcome_equity(outcome_flip(expected_reply(&next, 1, st)));
+    }
+
+    std::stable_sort(cands.begin(), cands.end(),
+                     [](candidate const & a, candidate const & b) {
+                       return a.score > b.score;
+                     });
+  }
+
+  st->searched = (keep > 1 ? keep : 0);
+
+  /*
+   * Stage 4 (only with a time limit): the closer the decision, the more
+   * time it gets to search the survivors two plies deeper, the most
+   * promising first. Plays not reached in time are dropped; unless at
+   * least two were searched, the result of stage 3 stands.
+   */
+  double const allot = (keep > 1 ? time_allot(&cfg->time, position_phase(pos), plays.size(),
+                                              cands[0].score - cands[1].score)
+                                 : 0.0);
+  std::vector<double> deep_scores;
+
+  while (deep_scores.size() < keep && time_used(&cfg->time) < allot) {
+    candidate const & c = cands[deep_scores.size()];
+    position next = c.p->result;
+    outcome value;
+
+    if (next.off[side_of(next.state.player)] == NUM_CHECKERS) {
+      deep_scores.push_back(c.score);
+      continue;
+    }
+
+    position_switch_player(&next);
+    if (!deep_reply(&next, &cfg->time, st, &value)) { break; }
+
+    deep_scores.push_back(outcome_equity(outcome_flip(value)));
+  }
+
+  if (deep_scores.size() > 1) {
+    cands.resize(deep_scores.size());
+    for (size_t cc = 0; cc < cands.size(); ++cc) { cands[cc].score = deep_scores[cc]; }
+
+    std::stable_sort(cands.begin(), cands.end(),
+                     [](candidate const & a, candidate const & b) {
+                       return a.score > b.score;
+                     });
+    st->deepened = deep_scores.size();
+  }
+
+  /* Equally good plays: the caller's generator decides, if there is one */
+  size_t ties = 1;
+  while (ties < cands.size() && cands[ties].score == cands[0].score) { ++ties; }
+
+  size_t const pick = (rng && ties > 1 ? search_rng_next(rng) % ties : 0);
+  *mmove = cands[pick].p->mmove;
+
+  stats_add_time(STATS_SEARCH, start);
+}
+
+double
+search_static_equity(position const * const pos)
+{
+  assert(pos);
+
+  play_vector plays;
+  outcome best;
+
+  generate_plays(pos, &plays);
+  best_static_play(plays, &best);
+  return outcome_equity(best);
+}
+
+bool
+search_ponder(position const * const pos, search_config const * const cfg,
+              bool (* const interrupted)())
+{
+  assert(pos && cfg && interrupted);
+
+  /* The game is over, if we have just borne off our last checker */
+  if (pos->off[side_of(-pos->state.player)] == NUM_CHECKERS) { return true; }
+
+  position rolled = *pos;
+  play_vector plays;
+  multi_move mmove;
+
+  /* Without a time limit, as the deep search does not poll 'interrupted' */
+  search_config unlimited = *cfg;
+  unlimited.time.limit = 0.0;
+
+  /* Mixed rolls (twice as likely) first, then the doubles */
+  for (unsigned int weight = 2; weight >= 1; --weight) {
+    for (roll_info const * roll = roll_begin(); roll != roll_end(); ++roll) {
+      if (roll->weight != weight) { continue; }
+      if (interrupted()) { return false; }
+
+      rolled.state.dice[0] = roll->dice[0];
+      rolled.state.dice[1] = roll->dice[1];
+      generate_plays(&rolled, &plays);
+
+      /* His reply as predicted by 'expected_reply' */
+      outcome predicted;
+      play const * const best = best_static_play(plays, &predicted);
+
+      position ours = best->result;
+      if (ours.off[side_of(ours.state.player)] == NUM_CHECKERS) { continue; }
+      position_switch_player(&ours);
+
+      for (roll_info const * our = roll_begin(); our != roll_end(); ++our) {
+        if (interrupted()) { return false; }
+
+        ours.state.dice[0] = our->dice[0];
+        ours.state.dice[1] = our->dice[1];
+        search_root(&ours, &unlimited, NULL, &mmove, NULL);
+      }
+    }
+  }
+
+  return true;
+}
+
+/* EOF */
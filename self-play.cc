@@ -0,0 +1,330 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <coroutine>
+#include <exception>
+#include <vector>
+
+#include <state.h>
+#include <position.h>
+#include <movegen.h>
+#include <eval.h>
+#include <search.h>
+
+/*
+ * Plays thousands of self-play games at once in a single thread, e.g. to
+ * measure the evaluation or to generate training data:
+ *
+ *   ./self-play -g 10000 -c 1000
+ *
+ * Every game is a C++20 coroutine. Whenever it needs positions evaluated,
+ * it hands them to the scheduler and suspends. Once all games wait, the
+ * scheduler evaluates the positions of all of them as one batch
+ * ('evaluate_batch') and resumes them with the results. The players choose
+ * the play with the best static equity (like the first stage of
+ * 'search_root'), the dice come from a generator seeded per game: the
+ * results only depend on the seed, not on the number of games in flight.
+ *
+ * This is the only C++20 code of the project (see the Makefile).
+ */
+
+namespace {
+
+/** Positions one game waits to be evaluated */
+typedef struct eval_request {
+  position const * positions;
+  size_t           count;
+  outcome *        results;
+} eval_request;
+
+/** Coroutine of one game (or several in a row), owned by the scheduler */
+struct game_task {
+  struct promise_type {
+    game_task get_return_object()
+    {
+      return game_task { std::coroutine_handle<promise_type>::from_promise(*this) };
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+
+  std::coroutine_handle<promise_type> coro;
+};
+
+class scheduler;
+
+/** 'co_await' of 'scheduler::evaluate' */
+struct evaluation {
+  scheduler *  sched;
+  eval_request request;
+
+  bool await_ready() const noexcept { return request.count == 0; }
+  void await_suspend(std::coroutine_handle<> coro);
+  void await_resume() const noexcept {}
+};
+
+/** Runs the games and evaluates their positions in batches */
+class scheduler {
+public:
+  scheduler()
+    : batches(0), evaluated(0), largest(0),
+      ready(), waiting(), requests(), batch(), results()
+  {}
+
+  scheduler(scheduler const &) = delete;
+  scheduler & operator=(scheduler const &) = delete;
+
+  ~scheduler()
+  {
+    for (std::coroutine_handle<> coro : ready) { coro.destroy(); }
+    for (std::coroutine_handle<> coro : waiting) { coro.destroy(); }
+  }
+
+  /** Take over the game 'task' (started by 'run') */
+  void spawn(game_task const task) { ready.push_back(task.coro); }
+
+  /** Have the 'count' positions at 'positions' evaluated into 'out' */
+  evaluation evaluate(position const * const positions, size_t const count,
+                      outcome * const out)
+  {
+    return evaluation { this, eval_request { positions, count, out } };
+  }
+
+  /** Called by a game that suspends on 'evaluate' */
+  void enqueue(eval_request const & request, std::coroutine_handle<> const coro)
+  {
+    requests.push_back(request);
+    waiting.push_back(coro);
+  }
+
+  /** Run all games to their end */
+  void run()
+  {
+    while (!ready.empty()) {
+      /* Every game runs until it waits for evaluations or ends */
+      for (std::coroutine_handle<> coro : ready) {
+        coro.resume();
+        if (coro.done()) { coro.destroy(); }
+      }
+      ready.clear();
+
+      flush();
+      ready.swap(waiting);
+    }
+  }
+
+  unsigned long long batches;   // evaluation batches so far
+  unsigned long long evaluated; // positions evaluated so far
+  size_t largest;               // positions of the largest batch
+
+private:
+  /* Evaluate the positions of all waiting games at once */
+  void flush()
+  {
+    batch.clear();
+    for (eval_request const & r : requests)
+      batch.insert(batch.end(), r.positions, r.positions + r.count);
+
+    if (batch.empty()) { return; }
+
+    results.resize(batch.size());
+    evaluate_batch(batch.data(), batch.size(), results.data());
+
+    outcome const * next = results.data();
+    for (eval_request const & r : requests) {
+      std::copy(next, next + r.count, r.results);
+      next += r.count;
+    }
+    requests.clear();
+
+    batches   += 1;
+    evaluated += batch.size();
+    if (batch.size() > largest) { largest = batch.size(); }
+  }
+
+  std::vector<std::coroutine_handle<>> ready;
+  std::vector<std::coroutine_handle<>> waiting;
+  std::vector<eval_request> requests;
+  std::vector<position> batch;
+  std::vector<outcome> results;
+};
+
+void
+evaluation::await_suspend(std::coroutine_handle<> const coro)
+{
+  sched->enqueue(request, coro);
+}
+
+/** Results of the games, by the side that started */
+typedef struct tally {
+  unsigned long games;
+  unsigned long wins[2];   // games won by the first and the second player
+  unsigned long points[2]; // points won (2 per gammon, 3 per backgammon)
+  unsigned long moves;
+} tally;
+
+unsigned short
+roll_die(search_rng * const rng)
+{
+  return 1 + search_rng_next(rng) % 6;
+}
+
+/*
+ * Play the games 'first', 'first + step', ... below 'total', each with the
+ * dice of the generator seeded by 'seed' and its number
+ */
+game_task
+play_games(scheduler * const sched, unsigned long const first,
+           unsigned long const step, unsigned long const total,
+           unsigned long long const seed, tally * const t)
+{
+  play_vector plays;
+  std::vector<position> candidates;
+  std::vector<outcome> values;
+
+  for (unsigned long game = first; game < total; game += step) {
+    search_rng rng;
+    search_rng_seed(&rng, seed + game);
+
+    game_state start;
+    position pos;
+
+    initialize_state(&start);
+    start.player = (search_rng_next(&rng) & 1 ? PLAYER_BELOW : PLAYER_ABOVE);
+    position_init(&pos, &start);
+
+    signed char const opener = pos.state.player;
+
+    /* The opening roll is never a double */
+    do {
+      pos.state.dice[0] = roll_die(&rng);
+      pos.state.dice[1] = roll_die(&rng);
+    } while (pos.state.dice[0] == pos.state.dice[1]);
+
+    while (1) {
+      generate_plays(&pos, &plays);
+
+      /* Each play is judged by the opponent's view of its result */
+      candidates.resize(plays.size());
+      values.resize(plays.size());
+      for (size_t pp = 0; pp < plays.size(); ++pp) {
+        candidates[pp] = plays[pp].result;
+        position_switch_player(&candidates[pp]);
+      }
+
+      co_await sched->evaluate(candidates.data(), candidates.size(), values.data());
+
+      /* The best play for us is the worst for him (the first of equals) */
+      size_t pick = 0;
+      for (size_t pp = 1; pp < plays.size(); ++pp) {
+        if (outcome_equity(values[pp]) < outcome_equity(values[pick])) { pick = pp; }
+      }
+
+      pos = plays[pick].result;
+      t->moves += 1;
+
+      if (pos.off[side_of(pos.state.player)] == NUM_CHECKERS) { break; }
+
+      position_switch_player(&pos);
+      pos.state.dice[0] = roll_die(&rng);
+      pos.state.dice[1] = roll_die(&rng);
+    }
+
+    /* Finished games are evaluated exactly: the loser's view tells the type */
+    size_t const seat = (pos.state.player == opener ? 0 : 1);
+    position_switch_player(&pos);
+    outcome const o = outcome_flip(evaluate_outcome(&pos));
+
+    t->games        += 1;
+    t->wins[seat]   += 1;
+    t->points[seat] += (unsigned long) (1.0 + o.win_gammon + o.win_backgammon + 0.5);
+  }
+}
+
+double
+seconds_since(struct timespec const * const start)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+void
+usage(char const * const prog)
+{
+  fprintf(stderr, "Usage: %s [-g games] [-c concurrent] [-s seed]\n"
+                  "  -g games      - Number of games to play (default: 1000)\n"
+                  "  -c concurrent - Games in flight at once (default: 1000)\n"
+                  "  -s seed       - Seed of the dice of the first game\n",
+          prog);
+}
+
+} // end anon namespace
+
+
+int
+main(int argc, char **argv)
+{
+  unsigned long games = 1000;
+  unsigned long concurrent = 1000;
+  unsigned long long seed = 1;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "g:c:s:")) != -1) {
+    switch (opt) {
+    case 'g': games      = strtoul(optarg, NULL, 0); break;
+    case 'c': concurrent = strtoul(optarg, NULL, 0); break;
+    case 's': seed       = strtoull(optarg, NULL, 0); break;
+    default:  usage(argv[0]); return 1;
+    }
+  }
+
+  if (optind != argc || concurrent == 0) {
+    usage(argv[0]);
+    return 1;
+  }
+  if (concurrent > games) { concurrent = games; }
+
+  std::vector<tally> tallies(concurrent, tally { 0, { 0, 0 }, { 0, 0 }, 0 });
+  scheduler sched;
+
+  for (unsigned long cc = 0; cc < concurrent; ++cc)
+    sched.spawn(play_games(&sched, cc, concurrent, games, seed, &tallies[cc]));
+
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  sched.run();
+
+  double const elapsed = seconds_since(&start);
+
+  tally sum = { 0, { 0, 0 }, { 0, 0 }, 0 };
+  for (tally const & t : tallies) {
+    sum.games += t.games;
+    sum.moves += t.moves;
+    for (size_t seat = 0; seat < 2; ++seat) {
+      sum.wins[seat]   += t.wins[seat];
+      sum.points[seat] += t.points[seat];
+    }
+  }
+
+  printf("%lu games, %lu moves: first player %lu wins (%lu points), "
+         "second player %lu wins (%lu points)\n",
+         sum.games, sum.moves, sum.wins[0], sum.points[0],
+         sum.wins[1], sum.points[1]);
+  printf("%llu positions in %llu batches (%.1f on average, at most %zu)\n",
+         sched.evaluated, sched.batches,
+         (sched.batches ? (double) sched.evaluated / sched.batches : 0.0),
+         sched.largest);
+  printf("%.3f s: %.1f games/s, %.0f positions/s\n", elapsed,
+         sum.games / elapsed, sched.evaluated / elapsed);
+
+  return 0;
+}
+
+/* EOF */
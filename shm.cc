@@ -0,0 +1,190 @@
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include <shm.h>
+
+namespace {
+
+#ifdef __linux__
+/* Shared (not process-private) futexes: the word lives in a shared mapping */
+void
+futex_wait(uint32_t * const word, uint32_t const expected, int const timeout_ms)
+{
+  struct timespec ts = { timeout_ms / 1000, (timeout_ms % 1000) * 1000000L };
+
+  /* Returns at once, if '*word' is no longer 'expected' */
+  syscall(SYS_futex, word, FUTEX_WAIT, expected, &ts, NULL, 0);
+}
+
+void
+futex_wake(uint32_t * const word, int const waiters)
+{
+  syscall(SYS_futex, word, FUTEX_WAKE, waiters, NULL, NULL, 0);
+}
+#else
+/*
+ * Elsewhere no region can be created or attached ('shm_create'), so the
+ * MCP and the players stay with the pipes and never get here
+ */
+void
+futex_wait(uint32_t * const, uint32_t const, int const)
+{
+}
+
+void
+futex_wake(uint32_t * const, int const)
+{
+}
+#endif
+
+uint32_t
+load(uint32_t const * const word)
+{
+  return __atomic_load_n(word, __ATOMIC_SEQ_CST);
+}
+
+void
+store(uint32_t * const word, uint32_t const value)
+{
+  __atomic_store_n(word, value, __ATOMIC_SEQ_CST);
+}
+
+/*
+ * Sleep on 'word' while it still has the value 'seen'. Announcing the
+ * sleeper in 'waiting' before checking 'word' again pairs with the writer,
+ * who changes 'word' before checking 'waiting': one of both sees the other.
+ */
+void
+sleep_on(uint32_t * const word, uint32_t * const waiting,
+         uint32_t const seen, int const timeout_ms)
+{
+  store(waiting, 1);
+  if (load(word) == seen) { futex_wait(word, seen, timeout_ms); }
+  store(waiting, 0);
+}
+
+} // end anon namespace
+
+
+void *
+shm_create(size_t const size, int * const fd)
+{
+  assert(fd);
+
+#ifdef __linux__
+  *fd = memfd_create("mcp-shm", MFD_CLOEXEC);
+#else
+  *fd = -1;
+#endif
+  if (*fd < 0) { return NULL; }
+
+  void * const region = (ftruncate(*fd, size) == 0 ? shm_attach(*fd, size) : NULL);
+
+  if (!region) { close(*fd); }
+  return region;
+}
+
+void *
+shm_attach(int const fd, size_t const size)
+{
+  void * const region = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  return (region == MAP_FAILED ? NULL : region);
+}
+
+void
+shm_detach(void * const region, size_t const size)
+{
+  if (region) { munmap(region, size); }
+}
+
+bool
+shm_send(shm_ring * const ring, char const * const msg, size_t const len)
+{
+  assert(ring && msg);
+
+  uint32_t const head = ring->head; // only written by us
+
+  if (len > MAX_MESSAGE_LEN || head - load(&ring->tail) >= SHM_SLOTS) { return false; }
+
+  memcpy(ring->msg[head % SHM_SLOTS], msg, len);
+  ring->len[head % SHM_SLOTS] = len;
+  store(&ring->head, head + 1);
+
+  if (load(&ring->waiting)) { futex_wake(&ring->head, 1); }
+  return true;
+}
+
+size_t
+shm_receive(shm_ring * const ring, char * const buf, size_t const size)
+{
+  assert(ring && buf && size > 0);
+
+  uint32_t const tail = ring->tail; // only written by us
+
+  if (load(&ring->head) == tail) { return 0; }
+
+  /* Never trust the other side: the message has to fit and end with 0 */
+  size_t len = ring->len[tail % SHM_SLOTS];
+  if (len > size) { len = size; }
+  if (len > MAX_MESSAGE_LEN) { len = MAX_MESSAGE_LEN; }
+  if (len == 0) { len = 1; }
+
+  memcpy(buf, ring->msg[tail % SHM_SLOTS], len);
+  buf[len - 1] = '\0';
+
+  store(&ring->tail, tail + 1);
+  return len;
+}
+
+bool
+shm_pending(shm_ring const * const ring)
+{
+  assert(ring);
+  return load(&ring->head) != load(&ring->tail);
+}
+
+bool
+shm_wait(shm_ring * const ring, int const timeout_ms)
+{
+  assert(ring);
+
+  uint32_t const head = load(&ring->head);
+
+  if (head == ring->tail) { sleep_on(&ring->head, &ring->waiting, head, timeout_ms); }
+  return shm_pending(ring);
+}
+
+uint32_t
+shm_bell_count(shm_bell const * const bell)
+{
+  assert(bell);
+  return load(&bell->rings);
+}
+
+void
+shm_bell_ring(shm_bell * const bell)
+{
+  assert(bell);
+
+  __atomic_add_fetch(&bell->rings, 1, __ATOMIC_SEQ_CST);
+  if (load(&bell->waiting)) { futex_wake(&bell->rings, INT_MAX); }
+}
+
+void
+shm_bell_wait(shm_bell * const bell, uint32_t const seen, int const timeout_ms)
+{
+  assert(bell);
+  sleep_on(&bell->rings, &bell->waiting, seen, timeout_ms);
+}
+
+/* EOF */
@@ -0,0 +1,349 @@
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <vector>
+
+/*
+ * Match manager for A/B tests of two players: plays them against each other
+ * until a sequential probability ratio test (SPRT) tells whether player A
+ * wins more points per game than player B by a margin, or not.
+ *
+ *   ./sprt my-player old-player
+ *   ./sprt -u 0.05 -j 4 my-player.so old-player.so
+ *   ./sprt my-player old-player -t 60 -T 61   (options for the MCP)
+ *
+ * Two MCPs play the match with the same seed ('mcp -s'), one with A as P-1
+ * and B as P1, the other one the other way round. Game n of both gets the
+ * same dice, so each player gets exactly the rolls the other one had, and
+ * much of the luck cancels out in the pair. The mean of the points A wins
+ * in both games of a pair ('winner') is the observation of the test:
+ *
+ *   H0: A wins 'low' points per game (default 0, i.e. no improvement)
+ *   H1: A wins 'high' points per game (default 0.1)
+ *
+ * After each pair the log-likelihood ratio of both hypotheses (normal
+ * approximation with the variance observed so far) is compared against the
+ * bounds given by the error probabilities 'alpha' and 'beta'; the match
+ * stops at the first pair where it crosses one of them.
+ *
+ * Exit status: 0 if H1 is accepted, 2 if H0 is accepted, 3 if 'max-pairs'
+ * were played without a decision, 1 on errors.
+ */
+
+namespace {
+
+enum {
+  SPRT_H1 = 0,
+  SPRT_ERROR = 1,
+  SPRT_H0 = 2,
+  SPRT_UNDECIDED = 3,
+  MIN_PAIRS = 16,    // pairs before the variance is trusted
+  LINE_LEN = 512,
+};
+
+/** Running MCP playing one half of the match */
+typedef struct match_run {
+  pid_t pid;          // also its process group (with the players)
+  int fd;             // its standard error
+  bool a_above;       // player A is P-1
+  char buf[LINE_LEN]; // incomplete line read so far
+  size_t len;
+  char last[LINE_LEN]; // last line that was not a result (for errors)
+} match_run;
+
+/** Observations so far: mean points A wins per game, by pairs */
+typedef struct sprt_state {
+  unsigned long pairs;
+  double sum;
+  double sum_sq;
+  long points[2]; // points won by A and B
+} sprt_state;
+
+int const NO_RESULT = -100;
+std::vector<int> results[2]; // per run and game: points won by A (or NO_RESULT)
+
+/* Start 'mcp' with the players 'first' (P-1) and 'second' (P1) */
+bool
+start_run(match_run * const run, std::vector<char const *> args,
+          char const * const first, char const * const second)
+{
+  int fds[2];
+  if (pipe(fds) < 0) { return false; }
+
+  args.push_back(first);
+  args.push_back(second);
+  args.push_back(NULL);
+
+  run->pid = fork();
+  if (run->pid < 0) { return false; }
+
+  if (run->pid == 0) {
+    /* A group of its own: the MCP and its players are stopped at once */
+    setpgid(0, 0);
+
+    int const null = open("/dev/null", O_WRONLY);
+    if (null < 0 || dup2(null, STDOUT_FILENO) < 0 || dup2(fds[1], STDERR_FILENO) < 0)
+      _exit(127);
+    close(fds[0]);
+
+    execv(args[0], (char * const *) args.data());
+    _exit(127);
+  }
+
+  setpgid(run->pid, run->pid);
+  close(fds[1]);
+
+  run->fd = fds[0];
+  run->len = 0;
+  run->last[0] = '\0';
+  return true;
+}
+
+void
+stop_run(match_run * const run)
+{
+  if (run->pid <= 0) { return; }
+
+  kill(-run->pid, SIGKILL);
+  waitpid(run->pid, NULL, 0);
+  run->pid = 0;
+}
+
+/* Log-likelihood ratio of H1 ('high') against H0 ('low') */
+double
+llr(sprt_state const * const s, double const low, double const high)
+{
+  if (s->pairs < MIN_PAIRS) { return 0.0; }
+
+  double const n = s->pairs;
+  double const mean = s->sum / n;
+  double var = (s->sum_sq - n * mean * mean) / (n - 1);
+  if (var < 1e-6) { var = 1e-6; }
+
+  return n * (high - low) * (2.0 * mean - low - high) / (2.0 * var);
+}
+
+/* Record a game of 'run' and complete its pair, if possible */
+void
+add_result(sprt_state * const s, unsigned const half,
+           unsigned long const game, int const points_a)
+{
+  if (game >= results[half].size()) { return; }
+
+  results[half][game] = points_a;
+
+  int const other = results[1 - half][game];
+  if (other == NO_RESULT) { return; }
+
+  double const y = 0.5 * (points_a + other);
+
+  s->pairs  += 1;
+  s->sum    += y;
+  s->sum_sq += y * y;
+
+  for (int const p : { points_a, other })
+    s->points[p > 0 ? 0 : 1] += abs(p);
+}
+
+/*
+ * Read what 'run' printed and add its results. Returns false when the MCP
+ * closed its standard error (i.e. it has finished).
+ */
+bool
+read_run(match_run * const run, unsigned const half, sprt_state * const s)
+{
+  ssize_t const n = read(run->fd, run->buf + run->len, sizeof(run->buf) - 1 - run->len);
+  if (n < 0) { return errno == EINTR; }
+  if (n == 0) { return false; }
+
+  run->len += n;
+  run->buf[run->len] = '\0';
+
+  char * line = run->buf;
+  char * end;
+
+  /* Complete lines (or a full buffer, which is cut into one) */
+  while ((end = strchr(line, '\n')) || (line == run->buf && run->len == sizeof(run->buf) - 1)) {
+    if (!end) { end = run->buf + run->len; }
+    *end = '\0';
+
+    unsigned long game;
+    int win;
+    if (sscanf(line, "Result of game %lu: %d", &game, &win) == 2)
+      add_result(s, half, game, (run->a_above ? -win : win));
+    else if (*line)
+      snprintf(run->last, sizeof(run->last), "%s", line);
+
+    line = (end == run->buf + run->len ? end : end + 1);
+  }
+
+  run->len -= line - run->buf;
+  memmove(run->buf, line, run->len);
+  return true;
+}
+
+void
+usage(char const * const prog)
+{
+  fprintf(stderr, "Usage: %s [-l low] [-u high] [-a alpha] [-b beta] [-n max-pairs]\n"
+                  "       [-j tables] [-s seed] [-m mcp] player-a player-b [mcp-option ...]\n"
+                  "  low, high   - Points per game A wins more than B under H0 and H1\n"
+                  "                (default: 0 and 0.1)\n"
+                  "  alpha, beta - Probabilities to accept H1 or H0 wrongly (default: 0.05)\n"
+                  "  max-pairs   - Stop undecided after as many pairs of games\n"
+                  "                (default: 10000)\n"
+                  "  tables      - Tables of each of the two MCPs (default: 1)\n"
+                  "  seed        - Seed of the dice (default: random)\n"
+                  "  mcp         - The MCP to run (default: ./mcp)\n",
+          prog);
+}
+
+} // end anon namespace
+
+
+int
+main(int argc, char **argv)
+{
+  double low = 0.0, high = 0.1, alpha = 0.05, beta = 0.05;
+  unsigned long max_pairs = 10000, tables = 1;
+  unsigned long long seed = time(NULL);
+  char const * mcp = "./mcp";
+  int opt;
+
+  /* '+': the options after the players belong to the MCP */
+  while ((opt = getopt(argc, argv, "+l:u:a:b:n:j:s:m:")) != -1) {
+    switch (opt) {
+    case 'l': low       = strtod(optarg, NULL); break;
+    case 'u': high      = strtod(optarg, NULL); break;
+    case 'a': alpha     = strtod(optarg, NULL); break;
+    case 'b': beta      = strtod(optarg, NULL); break;
+    case 'n': max_pairs = strtoul(optarg, NULL, 0); break;
+    case 'j': tables    = strtoul(optarg, NULL, 0); break;
+    case 's': seed      = strtoull(optarg, NULL, 0); break;
+    case 'm': mcp       = optarg; break;
+    default:  usage(argv[0]); return SPRT_ERROR;
+    }
+  }
+
+  if (optind + 2 > argc || !(high > low) || max_pairs == 0 || tables == 0 ||
+      !(alpha > 0.0 && alpha < 1.0) || !(beta > 0.0 && beta < 1.0)) {
+    usage(argv[0]);
+    return SPRT_ERROR;
+  }
+
+  char const * const player_a = argv[optind];
+  char const * const player_b = argv[optind + 1];
+
+  double const lower = log(beta / (1.0 - alpha));
+  double const upper = log((1.0 - beta) / alpha);
+
+  char seed_arg[32], games_arg[32], tables_arg[32];
+  snprintf(seed_arg, sizeof(seed_arg), "%llu", seed);
+  snprintf(games_arg, sizeof(games_arg), "%lu", max_pairs);
+  snprintf(tables_arg, sizeof(tables_arg), "%lu", tables);
+
+  std::vector<char const *> args = { mcp, "-s", seed_arg, "-n", games_arg,
+                                     "-j", tables_arg };
+  for (int arg = optind + 2; arg < argc; ++arg)
+    args.push_back(argv[arg]);
+
+  fprintf(stderr, "SPRT '%s' vs. '%s': H0 %+.3f, H1 %+.3f points per game, "
+                  "alpha %.3f, beta %.3f, seed %llu\n",
+          player_a, player_b, low, high, alpha, beta, seed);
+
+  /* Games are numbered from 1 */
+  for (unsigned half = 0; half < 2; ++half)
+    results[half].assign(max_pairs + 1, NO_RESULT);
+
+  match_run runs[2] = {};
+  runs[0].a_above = true;
+  runs[1].a_above = false;
+
+  if (!start_run(&runs[0], args, player_a, player_b) ||
+      !start_run(&runs[1], args, player_b, player_a)) {
+    perror("Unable to start the MCP");
+    return SPRT_ERROR;
+  }
+
+  sprt_state s = { 0, 0.0, 0.0, { 0, 0 } };
+  int verdict = SPRT_UNDECIDED;
+  unsigned running = 2;
+
+  while (running > 0 && verdict == SPRT_UNDECIDED) {
+    struct pollfd fds[2];
+    for (unsigned half = 0; half < 2; ++half)
+      fds[half] = { runs[half].fd, POLLIN, 0 };
+
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) { continue; }
+      perror("poll");
+      verdict = SPRT_ERROR;
+      break;
+    }
+
+    unsigned long const pairs = s.pairs;
+
+    for (unsigned half = 0; half < 2; ++half) {
+      if (runs[half].fd < 0 || !fds[half].revents) { continue; }
+      if (read_run(&runs[half], half, &s)) { continue; }
+
+      /* The MCP finished: all games played or someone misbehaved */
+      close(runs[half].fd);
+      runs[half].fd = -1;
+      --running;
+
+      int status = 0;
+      waitpid(runs[half].pid, &status, 0);
+      runs[half].pid = 0;
+
+      int const code = (WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+      if (code < 1 || code > 5) { continue; } // a win or a draw
+
+      fprintf(stderr, "MCP with '%s' as P-1 failed (%d): %s\n",
+              (runs[half].a_above ? player_a : player_b), code, runs[half].last);
+      verdict = SPRT_ERROR;
+    }
+
+    if (s.pairs == pairs || verdict != SPRT_UNDECIDED) { continue; }
+
+    double const ratio = llr(&s, low, high);
+    double const mean = s.sum / s.pairs;
+
+    fprintf(stderr, "Pairs %5lu: A %+.3f points per game (%ld : %ld), "
+                    "LLR %+.2f in [%.2f, %.2f]\n",
+            s.pairs, mean, s.points[0], s.points[1], ratio, lower, upper);
+
+    if (ratio >= upper) { verdict = SPRT_H1; }
+    if (ratio <= lower) { verdict = SPRT_H0; }
+  }
+
+  for (unsigned half = 0; half < 2; ++half)
+    stop_run(&runs[half]);
+
+  switch (verdict) {
+  case SPRT_H1:
+    printf("H1 accepted: '%s' is stronger than '%s' (%lu pairs)\n",
+           player_a, player_b, s.pairs);
+    break;
+  case SPRT_H0:
+    printf("H0 accepted: '%s' is not stronger than '%s' (%lu pairs)\n",
+           player_a, player_b, s.pairs);
+    break;
+  case SPRT_UNDECIDED:
+    printf("No decision after %lu pairs\n", s.pairs);
+    break;
+  }
+
+  return verdict;
+}
+
+/* EOF */
@@ -2,13 +2,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <poll.h>
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
 #include "state.h"
+#include "shm.h"
+#include "mcp.h"
 
-#define BUF_SIZE 512
+#define BUF_SIZE MAX_MESSAGE_LEN
 
 namespace {
 
@@ -16,24 +19,56 @@ enum {
   DRAWN_POS = 5, // number of checker positions drawn for each point
   PLAYER_ABOVE_SYM = 'x', // symbol for PLAYER_ABOVE
   PLAYER_BELOW_SYM = 'o', // symbol for PLAYER_BELOW
+  SHM_WAIT_MS = 1000, // how often a waiting player checks that the MCP is alive
 };
 
 
-// status for enforce strict alternation between reading and sending
-enum class Action {
-  INIT,
-  READ,
-  SEND
-};
+// connection used by the functions without an explicit context
+protocol_context *
+process_context()
+{
+  static protocol_context ctx;
+  static bool initialized = false;
+
+  if (!initialized) { protocol_init(&ctx); initialized = true; }
+  return &ctx;
+}
+
 
-enum class Type {
-  INIT,
-  MCP,
-  PLAYER
+// names of the protocol extensions as used in messages and MCP_FEATURES
+struct feature_name {
+  unsigned int feature;
+  char const * name;
+} const FEATURE_NAMES[] = {
+  { FEATURE_NEW_GAME, "new-game" },
+  { FEATURE_PONDER,   "ponder" },
+  { FEATURE_SHM,      "shm" },
 };
 
-Action last_action = Action::INIT;
-Type i_am = Type::INIT;
+char const FEATURES_VARIABLE[] = "MCP_FEATURES";
+char const TIME_VARIABLE[]     = "MCP_TIME";
+char const NEW_GAME_MESSAGE[]  = "new-game";
+
+
+// Parse a list of feature names separated by commas and/or blanks
+unsigned int
+parse_features(char const * list)
+{
+  unsigned int features = 0;
+
+  while (*list) {
+    size_t const len = strcspn(list, ", ");
+
+    for (feature_name const & f : FEATURE_NAMES)
+      if (strlen(f.name) == len && !strncmp(list, f.name, len))
+        features |= f.feature;
+
+    list += len;
+    list += strspn(list, ", ");
+  }
+
+  return features;
+}
 
 
 char
@@ -65,51 +100,123 @@ mark(signed short int const num_checkers, size_t const pos)
 } // end anon namespace
 
 
-bool
-serialize_state(int const fd, game_state const * const state)
+void
+protocol_init(protocol_context * const ctx)
 {
-  assert(state);
-  assert((i_am == Type::INIT || i_am == Type::MCP) && "Player trying to serialize field");
-  assert((last_action == Action::INIT || last_action == Action::READ) && "Send and Receive should alternate strictly");
+  assert(ctx);
 
-  i_am = Type::MCP; last_action = Action::SEND; // enforce send/read alternation
+  ctx->role        = ROLE_NONE;
+  ctx->last_action = ACTION_NONE;
+  ctx->trace       = stderr;
+  ctx->shm         = NULL;
+  ctx->bell        = NULL;
+}
+
+size_t
+format_state(char * const buf, size_t const size,
+             game_state const * const state)
+{
+  assert(buf && state);
 
-  char buf[BUF_SIZE];
   int bytes;
 
-  bytes = snprintf(buf, sizeof(buf), "%hhd %hu-%hu: (%hd %hd) %hd |",
+  bytes = snprintf(buf, size, "%hhd %hu-%hu: (%hd %hd) %hd |",
                    state->player, state->dice[0], state->dice[1],
                    get_higher_bar(state->board[POS_BAR]),
                    get_lower_bar(state->board[POS_BAR]),
                    state->board[POS_OFF]);
 
   for (size_t cc = 1; cc <= POINTS; cc++)
-    bytes += snprintf(buf + bytes, sizeof(buf) - bytes,
-                      " %hd", state->board[cc]);
+    bytes += snprintf(buf + bytes, size - bytes, " %hd", state->board[cc]);
+
+  return bytes + 1; // mind terminating 0-byte
+}
+
+bool
+serialize_state(int const fd, game_state const * const state)
+{
+  return serialize_state(process_context(), fd, state);
+}
+
+bool
+serialize_state(protocol_context * const ctx, int const fd,
+                game_state const * const state)
+{
+  assert(ctx && state);
+  assert((ctx->role == ROLE_NONE || ctx->role == ROLE_MCP) && "Player trying to serialize field");
+  assert((ctx->last_action == ACTION_NONE || ctx->last_action == ACTION_READ) && "Send and Receive should alternate strictly");
+
+  ctx->role = ROLE_MCP; ctx->last_action = ACTION_SEND; // enforce send/read alternation
 
-  fprintf(stderr, "> %s\n", buf);
-  return (write(fd, buf, bytes + 1) == (bytes + 1)); // mind terminating 0-byte
+  char buf[BUF_SIZE];
+  ssize_t const bytes = format_state(buf, sizeof(buf), state);
+
+  if (ctx->trace) { fprintf(ctx->trace, "> %s\n", buf); }
+  return (write(fd, buf, bytes) == bytes);
 }
 
 bool
 deserialize_state(int const fd, game_state * const state)
 {
-  assert(state);
-  assert((i_am == Type::INIT || i_am == Type::PLAYER) && "MCP trying to deserialize field");
-  assert((last_action == Action::INIT || last_action == Action::SEND) && "Send and Receive should alternate strictly");
+  return deserialize_state(process_context(), fd, state);
+}
 
-  i_am = Type::PLAYER; last_action = Action::READ; // enforce send/read alternation
+bool
+deserialize_state(protocol_context * const ctx, int const fd,
+                  game_state * const state)
+{
+  return (deserialize_message(ctx, fd, state) == MESSAGE_STATE);
+}
+
+message_type
+deserialize_message(int const fd, game_state * const state)
+{
+  return deserialize_message(process_context(), fd, state);
+}
+
+message_type
+deserialize_message(protocol_context * const ctx, int const fd,
+                    game_state * const state)
+{
+  assert(ctx && state);
+  assert((ctx->role == ROLE_NONE || ctx->role == ROLE_PLAYER) && "MCP trying to deserialize field");
+  assert((ctx->last_action == ACTION_NONE || ctx->last_action == ACTION_SEND) && "Send and Receive should alternate strictly");
+
+  ctx->role = ROLE_PLAYER; ctx->last_action = ACTION_READ; // enforce send/read alternation
 
 
   char buf[BUF_SIZE];
+
+  if (ctx->shm) {
+    /* Sleep on the ring, but notice if the MCP is gone (its pipe closed) */
+    while (!shm_receive(&ctx->shm->to_player, buf, sizeof(buf))) {
+      struct pollfd pfd = { fd, 0, 0 };
+
+      if (!shm_wait(&ctx->shm->to_player, SHM_WAIT_MS) &&
+          poll(&pfd, 1, 0) > 0 && (pfd.revents & (POLLHUP | POLLERR)))
+        return MESSAGE_INVALID;
+    }
+  } else {
+    int chars = read(fd, buf, sizeof(buf) - 1);
+
+    if (chars <= 0) { return MESSAGE_INVALID; }
+    buf[chars] = '\0';
+  }
+
+  if (!strcmp(buf, NEW_GAME_MESSAGE)) { return MESSAGE_NEW_GAME; }
+
+  return (parse_state(buf, state) ? MESSAGE_STATE : MESSAGE_INVALID);
+}
+
+bool
+parse_state(char const * const msg, game_state * const state)
+{
+  assert(msg && state);
+
   signed short int higher_bar = 0, lower_bar = 0;
   signed short int * const b = state->board;
-  int chars = read(fd, buf, sizeof(buf) - 1);
 
-  if (chars <= 0) { return false; }
-  buf[chars] = '\0';
-
-  int res = sscanf(buf, "%hhd %hu-%hu: " // player + dice
+  int res = sscanf(msg, "%hhd %hu-%hu: " // player + dice
                         "(%hd %hd) %hd | " // bar (P-1, P1) + off
                         "%hd %hd %hd %hd %hd %hd %hd %hd %hd %hd %hd %hd "
                         "%hd %hd %hd %hd %hd %hd %hd %hd %hd %hd %hd %hd",
@@ -127,37 +234,116 @@ deserialize_state(int const fd, game_state * const state)
   return (30 == res);
 }
 
+size_t
+format_new_game(char * const buf, size_t const size)
+{
+  assert(buf && size >= sizeof(NEW_GAME_MESSAGE));
+
+  memcpy(buf, NEW_GAME_MESSAGE, sizeof(NEW_GAME_MESSAGE));
+  return sizeof(NEW_GAME_MESSAGE); // mind terminating 0-byte
+}
+
+bool
+serialize_new_game(int const fd)
+{
+  return serialize_new_game(process_context(), fd);
+}
+
+bool
+serialize_new_game(protocol_context * const ctx, int const fd)
+{
+  assert(ctx);
+  assert((ctx->role == ROLE_NONE || ctx->role == ROLE_MCP) && "Player trying to announce a new game");
+  assert((ctx->last_action == ACTION_NONE || ctx->last_action == ACTION_READ) && "Send and Receive should alternate strictly");
+
+  ctx->role = ROLE_MCP; ctx->last_action = ACTION_SEND; // enforce send/read alternation
+
+  char buf[BUF_SIZE];
+  ssize_t const bytes = format_new_game(buf, sizeof(buf));
+
+  if (ctx->trace) { fprintf(ctx->trace, "> %s\n", buf); }
+  return (write(fd, buf, bytes) == bytes);
+}
+
 bool
 serialize_moves(int const fd, multi_move const * const mmove)
 {
-  assert(mmove && mmove->num_moves <= MAX_MOVES);
-  assert(i_am == Type::PLAYER && "Non-Player (MCP or player before reading field) trying to serialize moves");
-  assert(last_action == Action::READ && "Send and Receive should alternate strictly");
+  return serialize_moves(process_context(), fd, mmove, 0);
+}
 
-  last_action = Action::SEND; // enforce send/read alternation
+bool
+serialize_moves(int const fd, multi_move const * const mmove,
+                unsigned int const features)
+{
+  return serialize_moves(process_context(), fd, mmove, features);
+}
+
+bool
+serialize_moves(protocol_context * const ctx, int const fd,
+                multi_move const * const mmove, unsigned int const features)
+{
+  assert(ctx && mmove && mmove->num_moves <= MAX_MOVES);
+  assert(ctx->role == ROLE_PLAYER && "Non-Player (MCP or player before reading field) trying to serialize moves");
+  assert(ctx->last_action == ACTION_READ && "Send and Receive should alternate strictly");
+
+  ctx->last_action = ACTION_SEND; // enforce send/read alternation
+
+  /* Switch to shared memory after this answer, if we can map it */
+  unsigned int confirmed = features;
+  shm_channel * shm = NULL;
+  shm_bell * bell = NULL;
+
+  if ((features & FEATURE_SHM) && !ctx->shm) {
+    shm  = (shm_channel *) shm_attach(CHILD_SHM_FD, sizeof(shm_channel));
+    bell = (shm_bell *) shm_attach(CHILD_BELL_FD, sizeof(shm_bell));
+
+    if (!shm || !bell) {
+      shm_detach(shm, sizeof(shm_channel));
+      shm_detach(bell, sizeof(shm_bell));
+      shm = NULL; bell = NULL;
+      confirmed &= ~FEATURE_SHM;
+    }
+  }
 
 
   char buf[BUF_SIZE];
-  int bytes;
+  ssize_t const bytes = format_moves(buf, sizeof(buf), mmove, confirmed);
 
-  bytes = snprintf(buf, sizeof(buf), "%hhu |", mmove->num_moves);
+  if (ctx->shm) {
+    if (!shm_send(&ctx->shm->from_player, buf, bytes)) { return false; }
+    shm_bell_ring(ctx->bell);
+    return true;
+  }
 
-  for (size_t cc = 0; cc < mmove->num_moves; ++cc)
-    bytes += snprintf(buf + bytes, sizeof(buf) - bytes, " (%hu,%hu)",
-                      mmove->moves[cc].point_from,
-                      mmove->moves[cc].roll);
+  bool const ok = (write(fd, buf, bytes) == bytes);
 
-  return (write(fd, buf, bytes + 1) == (bytes + 1)); // mind terminating 0-byte
+  if (shm) { ctx->shm = shm; ctx->bell = bell; }
+  return ok;
 }
 
 bool
 deserialize_moves(int const fd, multi_move * const mmove)
 {
-  assert(mmove);
-  assert(i_am == Type::MCP && "Non-MCP (Player or MCP before serializing field) trying to deserialize moves");
-  assert(last_action == Action::SEND && "Send and Receive should alternate strictly");
+  unsigned int features;
+  return deserialize_moves(process_context(), fd, mmove, &features);
+}
+
+bool
+deserialize_moves(int const fd, multi_move * const mmove,
+                  unsigned int * const features)
+{
+  return deserialize_moves(process_context(), fd, mmove, features);
+}
 
-  last_action = Action::READ; // enforce send/read alternation
+bool
+deserialize_moves(protocol_context * const ctx, int const fd,
+                  multi_move * const mmove, unsigned int * const features)
+{
+  assert(ctx && mmove && features);
+  assert(ctx->role == ROLE_MCP && "Non-MCP (Player or MCP before serializing field) trying to deserialize moves");
+  assert(ctx->last_action == ACTION_SEND && "Send and Receive should alternate strictly");
+
+  ctx->last_action = ACTION_READ; // enforce send/read alternation
 
 
   char buf[BUF_SIZE];
@@ -166,17 +352,115 @@ deserialize_moves(int const fd, multi_move * const mmove)
   if (chars < 0) { return false; }
   buf[chars] = 0;
 
-  int res = sscanf(buf, "%hhu | (%hu,%hu) (%hu,%hu) (%hu,%hu) (%hu,%hu)",
+  if (ctx->trace) { fprintf(ctx->trace, "< %s\n", buf); }
+
+  return parse_moves(buf, mmove, features);
+}
+
+size_t
+format_moves(char * const buf, size_t const size,
+             multi_move const * const mmove, unsigned int const features)
+{
+  assert(buf && mmove && mmove->num_moves <= MAX_MOVES);
+
+  int bytes;
+
+  bytes = snprintf(buf, size, "%hhu |", mmove->num_moves);
+
+  for (size_t cc = 0; cc < mmove->num_moves; ++cc)
+    bytes += snprintf(buf + bytes, size - bytes, " (%hu,%hu)",
+                      mmove->moves[cc].point_from,
+                      mmove->moves[cc].roll);
+
+  /* Confirm the protocol extensions we support */
+  if (features) {
+    bytes += snprintf(buf + bytes, size - bytes, " ;");
+
+    for (feature_name const & f : FEATURE_NAMES)
+      if (features & f.feature)
+        bytes += snprintf(buf + bytes, size - bytes, " %s", f.name);
+  }
+
+  return bytes + 1; // mind terminating 0-byte
+}
+
+bool
+parse_moves(char const * const msg, multi_move * const mmove,
+            unsigned int * const features)
+{
+  assert(msg && mmove && features);
+
+  int res = sscanf(msg, "%hhu | (%hu,%hu) (%hu,%hu) (%hu,%hu) (%hu,%hu)",
                    &mmove->num_moves,
                    &mmove->moves[0].point_from, &mmove->moves[0].roll,
                    &mmove->moves[1].point_from, &mmove->moves[1].roll,
                    &mmove->moves[2].point_from, &mmove->moves[2].roll,
                    &mmove->moves[3].point_from, &mmove->moves[3].roll);
 
-  fprintf(stderr, "< %s\n", buf);
+  /* Protocol extensions confirmed by the player (if any) */
+  char const * const list = strchr(msg, ';');
+  *features = (list ? parse_features(list + 1) : 0);
+
   return ( (res >= 1) && (res == 1 + 2 * mmove->num_moves) );
 }
 
+bool
+poll_message(int const fd)
+{
+  protocol_context const * const ctx = process_context();
+
+  if (ctx->shm) { return shm_pending(&ctx->shm->to_player); }
+
+  struct pollfd pfd = { fd, POLLIN, 0 };
+  return poll(&pfd, 1, 0) != 0;
+}
+
+unsigned int
+announced_features()
+{
+  char const * const list = getenv(FEATURES_VARIABLE);
+  return (list ? parse_features(list) : 0);
+}
+
+bool
+announce_features(unsigned int const features)
+{
+  char list[BUF_SIZE] = "";
+  size_t len = 0;
+
+  for (feature_name const & f : FEATURE_NAMES)
+    if (features & f.feature)
+      len += snprintf(list + len, sizeof(list) - len, "%s%s",
+                      (len ? "," : ""), f.name);
+
+  return (setenv(FEATURES_VARIABLE, list, 1) == 0);
+}
+
+bool
+announced_time_limits(double * const soft, double * const hard)
+{
+  assert(soft && hard);
+
+  *soft = *hard = 0.0;
+
+  char const * const limits = getenv(TIME_VARIABLE);
+  if (!limits || sscanf(limits, "%lf,%lf", soft, hard) != 2 || !(*soft > 0.0)) {
+    *soft = *hard = 0.0;
+    return false;
+  }
+  if (*hard < *soft) { *hard = *soft; }
+  return true;
+}
+
+bool
+announce_time_limits(unsigned long const soft, unsigned long const hard)
+{
+  char limits[BUF_SIZE];
+
+  snprintf(limits, sizeof(limits), "%lu,%lu", soft, hard);
+  return (setenv(TIME_VARIABLE, limits, 1) == 0);
+}
+
 void
 initialize_multi_move(multi_move * const mmove)
 {
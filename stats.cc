@@ -0,0 +1,144 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <stats.h>
+
+namespace {
+
+char const * const TIME_NAMES[NUM_STATS_PHASES] = { "generate", "evaluate", "search" };
+
+struct move_counters {
+  unsigned long expanded[STATS_MAX_PLY];  // positions given to the generator
+  unsigned long generated[STATS_MAX_PLY]; // plays it returned
+  unsigned long evaluations;
+  unsigned long tt_probes;
+  unsigned long tt_hits;
+  double seconds[NUM_STATS_PHASES];
+};
+
+FILE * out = NULL;       // side file, NULL while switched off
+unsigned long moves = 0; // moves written so far
+
+move_counters cur;
+position move_pos;
+double move_start;
+
+double
+now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+unsigned long
+micros(double const seconds)
+{
+  return (unsigned long) (seconds * 1e6 + 0.5);
+}
+
+} // end anon namespace
+
+
+bool
+stats_init()
+{
+  char const * const path = getenv("PLAYER_STATS");
+  if (!path || !*path) { return true; }
+
+  out = fopen(path, "a");
+  if (!out) { return false; }
+
+  /* Keep lines whole, even if the player is killed between two moves */
+  setvbuf(out, NULL, _IOLBF, 0);
+  return true;
+}
+
+bool
+stats_enabled()
+{
+  return out != NULL;
+}
+
+void
+stats_begin_move(position const * const pos)
+{
+  assert(pos);
+  if (!out) { return; }
+
+  memset(&cur, 0, sizeof(cur));
+  move_pos = *pos;
+  move_start = now();
+}
+
+void
+stats_end_move(search_stats const * const search)
+{
+  if (!out) { return; }
+
+  double const total = now() - move_start;
+  game_state const * const s = &move_pos.state;
+
+  fprintf(out, "{\"move\":%lu,\"player\":%d,\"dice\":[%hu,%hu],"
+               "\"phase\":\"%s\",\"book\":%s,\"plies\":[",
+          ++moves, s->player, s->dice[0], s->dice[1],
+          PHASE_NAMES[position_phase(&move_pos)], (search ? "false" : "true"));
+
+  for (size_t ply = 0; ply < STATS_MAX_PLY; ++ply)
+    fprintf(out, "%s{\"expanded\":%lu,\"generated\":%lu}", (ply ? "," : ""),
+            cur.expanded[ply], cur.generated[ply]);
+
+  fprintf(out, "],\"evaluations\":%lu,\"tt_probes\":%lu,\"tt_hits\":%lu",
+          cur.evaluations, cur.tt_probes, cur.tt_hits);
+
+  if (search)
+    fprintf(out, ",\"nodes\":%lu,\"searched\":%lu,\"deepened\":%lu",
+            search->nodes, search->searched, search->deepened);
+
+  fprintf(out, ",\"us\":{");
+  for (size_t phase = 0; phase < NUM_STATS_PHASES; ++phase)
+    fprintf(out, "\"%s\":%lu,", TIME_NAMES[phase], micros(cur.seconds[phase]));
+  fprintf(out, "\"total\":%lu}}\n", micros(total));
+}
+
+void
+stats_count_generated(unsigned int const ply, unsigned long const plays)
+{
+  if (!out) { return; }
+
+  assert(ply < STATS_MAX_PLY);
+  cur.expanded[ply]++;
+  cur.generated[ply] += plays;
+}
+
+void
+stats_count_evaluations(unsigned long const num)
+{
+  if (out) { cur.evaluations += num; }
+}
+
+void
+stats_count_probe(bool const hit)
+{
+  if (!out) { return; }
+
+  cur.tt_probes++;
+  if (hit) { cur.tt_hits++; }
+}
+
+double
+stats_clock()
+{
+  return (out ? now() : 0.0);
+}
+
+void
+stats_add_time(stats_phase const phase, double const start)
+{
+  if (out) { cur.seconds[phase] += now() - start; }
+}
+
+/* EOF */
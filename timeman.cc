@@ -0,0 +1,91 @@
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <state.h>
+#include <timeman.h>
+
+namespace {
+
+double const TIME_MAX_SHARE  = 0.5; // of the limit for the hardest decisions
+double const TIME_STOP_SHARE = 0.8; // of the limit: stop, whatever is left
+double const GAP_SCALE       = 0.05; // equity gap that makes a decision easy
+double const BREADTH_PLAYS   = 8.0;  // plays that make a decision half as hard
+
+/* How much a decision in each phase can gain from a deeper look */
+double const PHASE_SHARE[NUM_PHASES] = {
+  1.0,  // contact: hits, primes and blots are what the evaluation misses
+  0.3,  // race: the race formulas are already good
+  0.1,  // bear-off: hardly ever close
+};
+
+double
+now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+} // end anon namespace
+
+
+bool
+time_init(time_budget * const budget)
+{
+  assert(budget);
+
+  /* The MCP measures the time of a move on the wall clock */
+  double hard;
+  announced_time_limits(&budget->limit, &hard);
+  budget->start = now();
+
+  char const * const env = getenv("PLAYER_TIME");
+  if (!env) { return true; }
+
+  char * end;
+  double const limit = strtod(env, &end);
+  if (end == env || *end || !(limit >= 0.0)) { return false; }
+
+  budget->limit = limit;
+  return true;
+}
+
+void
+time_begin_move(time_budget * const budget)
+{
+  assert(budget);
+  budget->start = now();
+}
+
+double
+time_used(time_budget const * const budget)
+{
+  assert(budget);
+  return now() - budget->start;
+}
+
+double
+time_allot(time_budget const * const budget, game_phase const phase,
+           size_t const plays, double const gap)
+{
+  assert(budget && phase < NUM_PHASES);
+
+  if (budget->limit <= 0.0 || plays < 2) { return 0.0; }
+
+  /* Close decisions between many plays are hard */
+  double const closeness = exp(-fabs(gap) / GAP_SCALE);
+  double const breadth   = plays / (plays + BREADTH_PLAYS);
+
+  return budget->limit * TIME_MAX_SHARE * PHASE_SHARE[phase] * closeness * breadth;
+}
+
+bool
+time_up(time_budget const * const budget)
+{
+  assert(budget);
+  return budget->limit > 0.0 && time_used(budget) >= budget->limit * TIME_STOP_SHARE;
+}
+
+/* EOF */
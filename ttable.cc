@@ -0,0 +1,99 @@
+#include <assert.h>
+#include <new>
+#include <vector>
+
+#include <ttable.h>
+
+namespace {
+
+struct tt_entry {
+  unsigned long long key;
+  outcome value;       // kept exact: a hit must not change any decision
+  unsigned int nodes;  // size of the search tree behind 'value'
+  unsigned char depth; // 0 marks an empty entry
+};
+
+enum {
+  DEFAULT_ENTRIES = 1 << 16,
+  MIN_ENTRIES     = 1 << 10,
+};
+
+std::vector<tt_entry> table;
+size_t mask = 0;
+
+/* Each depth has its own slot for a key, so results of both depths coexist */
+tt_entry *
+slot(unsigned long long const key, unsigned int const depth)
+{
+  if (table.empty()) { tt_resize(DEFAULT_ENTRIES); }
+  return &table[(key ^ depth * 0x9e3779b97f4a7c15ULL) & mask];
+}
+
+} // end anon namespace
+
+
+bool
+tt_resize(size_t const entries)
+{
+  size_t size = 1;
+
+  while (size * 2 <= entries) { size *= 2; }
+
+  /* Release the old table first, so its memory counts for the new one */
+  std::vector<tt_entry>().swap(table);
+
+  try {
+    std::vector<tt_entry>(size).swap(table); // all entries empty
+  } catch (std::bad_alloc const &) {
+    return false;
+  }
+
+  mask = size - 1;
+  return true;
+}
+
+size_t
+tt_fit(size_t const bytes)
+{
+  for (size_t entries = bytes / sizeof(tt_entry); entries >= MIN_ENTRIES; entries /= 2)
+    if (tt_resize(entries)) { return table.size() * sizeof(tt_entry); }
+
+  return 0;
+}
+
+void
+tt_clear()
+{
+  for (tt_entry & e : table) { e.key = 0; e.value = outcome(); e.nodes = 0; e.depth = 0; }
+}
+
+bool
+tt_probe(unsigned long long const key, unsigned int const depth,
+         outcome * const value, unsigned int * const nodes)
+{
+  assert(value && nodes && depth > 0);
+
+  tt_entry const * const e = slot(key, depth);
+
+  if (e->depth != depth || e->key != key) { return false; }
+
+  *value = e->value;
+  *nodes = e->nodes;
+  return true;
+}
+
+void
+tt_store(unsigned long long const key, unsigned int const depth,
+         outcome const & value, unsigned int const nodes)
+{
+  assert(depth > 0 && depth < 256);
+
+  tt_entry * const e = slot(key, depth);
+
+  e->key   = key;
+  e->value = value;
+  e->nodes = nodes;
+  e->depth = depth;
+}
+
+/* EOF */